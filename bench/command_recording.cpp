@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "core/scheduler_stats.h"
+#include "core/worker_thread.h"
+#include "ext_opengl/gl_commands.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace lemon;
+
+// Mesh blocks drawn per frame
+#define BLOCK_COUNT 20000
+// Blocks recorded into each command list, as in the bootstrap renderer
+#define BLOCKS_PER_LIST 64
+// Frames recorded per measurement
+#define FRAMES 200
+
+int main()
+{
+    auto ranges = (BLOCK_COUNT + BLOCKS_PER_LIST - 1) / BLOCKS_PER_LIST;
+    // Buffer names of each block, and of the bodies bound alongside them
+    std::vector<std::shared_ptr<const GLuint>> blocks;
+    for (int i = 0; i < BLOCK_COUNT; i++)
+        blocks.push_back(std::make_shared<const GLuint>(i + 2));
+    auto bodies = std::make_shared<const GLuint>(1);
+
+    std::vector<std::unique_ptr<gl_command_buffer>> lists;
+    for (int i = 0; i < ranges; i++)
+        lists.push_back(std::make_unique<gl_command_buffer>());
+
+    auto record = [&](size_t range)
+    {
+        auto& list = *lists[range];
+        list.bind_buffer_base(GL_SHADER_STORAGE_BUFFER, 1, bodies);
+
+        auto end = std::min((size_t)BLOCK_COUNT, (range + 1) * BLOCKS_PER_LIST);
+        for (auto i = range * BLOCKS_PER_LIST; i < end; i++)
+        {
+            list.bind_buffer_base(GL_SHADER_STORAGE_BUFFER, 0, blocks[i]);
+
+            list.draw_arrays(GL_TRIANGLES, 0, 3);
+        }
+    };
+
+    printf("%d blocks in lists of %d, %d frames\n", BLOCK_COUNT, BLOCKS_PER_LIST, FRAMES);
+
+    int max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+        // The recording thread takes part, so the pool has one fewer worker
+        std::unique_ptr<worker_pool> pool;
+        if (threads > 1)
+            pool = std::make_unique<worker_pool>(threads - 1);
+
+        long long total = 0;
+        for (int frame = 0; frame < FRAMES; frame++)
+        {
+            for (auto& list : lists)
+                list->reset();
+
+            auto start = scheduler_now();
+            if (pool)
+                pool->parallel_for(0, ranges, record, 1);
+            else
+                for (int range = 0; range < ranges; range++)
+                    record(range);
+            total += scheduler_now() - start;
+        }
+
+        printf("%2d recording thread(s): %8.1f us per frame\n", threads, total / 1e3 / FRAMES);
+    }
+
+    return 0;
+}
@@ -0,0 +1,221 @@
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <streambuf>
+#include <string>
+
+#include "core/logger.h"
+#include "core/scheduler_stats.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace lemon;
+
+// Messages logged per measurement
+#define MESSAGE_COUNT 200000
+
+// Default pattern of the logger, as defined in its implementation file
+#define PATTERN "\033[0;37m%d{yyyy-MM-dd} %t{hh:mm:ss}\033\
+[1;36m[%5p\033[1;36m][\033[1;37m%-15c\033[1;36m]\033[0;37m: %m%n\033[0m"
+
+/**
+ * @brief Stream buffer which discards everything written to it, so that
+ *      only formatting is measured.
+ */
+struct null_buffer : std::streambuf
+{
+    int overflow(int c) override
+    {
+        return c;
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize count) override
+    {
+        return count;
+    }
+};
+
+/**
+ * @brief Prints justified text, as the logger did before compiling patterns.
+ */
+void legacy_print(std::string& out, const std::string& message, int width, bool left_justify)
+{
+    if (!left_justify)
+        out += message.substr(0, width == 0 ? message.length() : width);
+    for (int i = 0; i < width - (int)message.length(); i++)
+        out += ' ';
+    if (left_justify)
+        out += message.substr(0, width == 0 ? message.length() : width);
+}
+
+/**
+ * The logger's formatting before patterns were compiled, which parsed the
+ * pattern, localized the time for each field, and used `pow` per digit for
+ * every record.
+ *
+ * @brief Formats a message by parsing the pattern for this record alone.
+ */
+void legacy_format(const std::string& pattern, const std::string& name, std::string level,
+    const char* level_color, const std::string& message, time_t now, std::string& out)
+{
+    bool within_brackets = false;
+    bool within_token = false;
+    bool is_left_justify = false;
+    int num_digits_accum = 0;
+
+    auto date_time = localtime(&now);
+    char prev_digit = ' ';
+    int num_digit_count = 0;
+
+    for (char c : pattern)
+    {
+        if (within_brackets)
+        {
+            if (c == prev_digit)
+                num_digit_count++;
+            else
+            {
+                num_digit_count = 0;
+
+                date_time = localtime(&now);
+                date_time->tm_year += 1900;
+                date_time->tm_mon += 1;
+            }
+
+            switch (c)
+            {
+            case 'y':
+                out += std::to_string(date_time->tm_year / (int)pow(10, 3 - num_digit_count));
+                date_time->tm_year %= (int)pow(10, 3 - num_digit_count);
+                break;
+            case 'M':
+                out += std::to_string(date_time->tm_mon / (int)pow(10, 1 - num_digit_count));
+                date_time->tm_mon %= (int)pow(10, 1 - num_digit_count);
+                break;
+            case 'd':
+                out += std::to_string(date_time->tm_mday / (int)pow(10, 1 - num_digit_count));
+                date_time->tm_mday %= (int)pow(10, 1 - num_digit_count);
+                break;
+            case 'h':
+                out += std::to_string(date_time->tm_hour / (int)pow(10, 1 - num_digit_count));
+                date_time->tm_hour %= (int)pow(10, 1 - num_digit_count);
+                break;
+            case 'm':
+                out += std::to_string(date_time->tm_min / (int)pow(10, 1 - num_digit_count));
+                date_time->tm_min %= (int)pow(10, 1 - num_digit_count);
+                break;
+            case 's':
+                out += std::to_string(date_time->tm_sec / (int)pow(10, 1 - num_digit_count));
+                date_time->tm_sec %= (int)pow(10, 1 - num_digit_count);
+                break;
+
+            case '}':
+                within_brackets = false;
+                within_token = false;
+                break;
+
+            default:
+                out += c;
+            }
+
+            prev_digit = c;
+        } else if (within_token)
+        {
+            switch (c)
+            {
+            case '{':
+                within_brackets = true;
+                break;
+
+            case 'd':
+            case 't':
+                break;
+
+            case 'm':
+                legacy_print(out, message, num_digits_accum, is_left_justify);
+                within_token = false;
+                break;
+            case 'c':
+                legacy_print(out, name, num_digits_accum, is_left_justify);
+                within_token = false;
+                break;
+            case 'n':
+                out += '\n';
+                within_token = false;
+                break;
+            case 'p':
+                out += level_color;
+                legacy_print(out, level, num_digits_accum, is_left_justify);
+                within_token = false;
+                break;
+
+            case '-':
+                is_left_justify = true;
+                break;
+
+            default:
+                if (c >= '0' && c <= '9')
+                    num_digits_accum = num_digits_accum * 10 + (c - '0');
+                else
+                    within_token = false;
+            }
+        } else if (c == '%')
+        {
+            within_token = true;
+            is_left_justify = false;
+            num_digits_accum = 0;
+        } else
+            out += c;
+    }
+}
+
+int main()
+{
+    printf("%d synchronous info messages, output discarded\n", MESSAGE_COUNT);
+
+    null_buffer discard;
+    auto console = std::cout.rdbuf(&discard);
+
+    long long legacy_ns, compiled_ns;
+
+    {   /* PARSED PER RECORD */
+        std::string pattern = PATTERN, name = "Benchmark", message = "Frame 42 rendered";
+        std::string text;
+
+        auto start = scheduler_now();
+        for (int i = 0; i < MESSAGE_COUNT; i++)
+        {
+            text.clear();
+            legacy_format(pattern, name, "INFO", "\033[1;32m", message, time(nullptr), text);
+
+            std::cout.write(text.data(), text.size());
+            std::cout.flush();
+        }
+        legacy_ns = scheduler_now() - start;
+    }
+
+    {   /* COMPILED PATTERN */
+        logger log(PATTERN, "Benchmark");
+
+        auto start = scheduler_now();
+        for (int i = 0; i < MESSAGE_COUNT; i++)
+            log.info("Frame {} rendered", 42);
+        compiled_ns = scheduler_now() - start;
+    }
+
+    std::cout.rdbuf(console);
+
+    printf("parsed per record: %8.1f ns/message\n", (double)legacy_ns / MESSAGE_COUNT);
+    printf("compiled pattern:  %8.1f ns/message\n", (double)compiled_ns / MESSAGE_COUNT);
+
+    return 0;
+}
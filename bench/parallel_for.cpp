@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "core/logger.h"
+#include "core/scheduler_stats.h"
+#include "core/static_mesh.h"
+#include "core/worker_thread.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace lemon;
+
+// Vertices transformed per pass
+#define VERTEX_COUNT 1500000
+// Passes averaged per measurement
+#define PASSES 20
+
+/**
+ * @brief Transforms a vertex's position by a column-major matrix.
+ */
+void transform(const mat4& m, vertex& v)
+{
+    auto p = v.position;
+
+    v.position.x = m.values[0][0] * p.x + m.values[1][0] * p.y + m.values[2][0] * p.z + m.values[3][0] * p.w;
+    v.position.y = m.values[0][1] * p.x + m.values[1][1] * p.y + m.values[2][1] * p.z + m.values[3][1] * p.w;
+    v.position.z = m.values[0][2] * p.x + m.values[1][2] * p.y + m.values[2][2] * p.z + m.values[3][2] * p.w;
+    v.position.w = m.values[0][3] * p.x + m.values[1][3] * p.y + m.values[2][3] * p.z + m.values[3][3] * p.w;
+}
+
+int main()
+{
+    // Keep pool startup messages out of the results
+    logger::set_level(log_level::info);
+
+    std::vector<vertex> vertices(VERTEX_COUNT);
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        vertices[i].position.x = (float)i;
+        vertices[i].position.y = 1.0f;
+        vertices[i].position.z = 2.0f;
+        vertices[i].position.w = 1.0f;
+    }
+
+    auto m = mat::perspective(14.0f / 9.0f, 1.57f, 0.1f, 512.0f);
+
+    printf("%d vertices transformed, %d passes per measurement\n", VERTEX_COUNT, PASSES);
+
+    {   /* SERIAL LOOP */
+        auto start = scheduler_now();
+        for (int pass = 0; pass < PASSES; pass++)
+            for (auto& v : vertices)
+                transform(m, v);
+
+        printf("serial loop:             %6.2f ms/pass\n", (scheduler_now() - start) / 1e6 / PASSES);
+    }
+
+    int max_workers = std::max(8u, std::thread::hardware_concurrency());
+    for (int workers = 1; workers <= max_workers; workers *= 2)
+    {   /* PARALLEL FOR */
+        worker_pool pool(workers);
+
+        auto start = scheduler_now();
+        for (int pass = 0; pass < PASSES; pass++)
+            pool.parallel_for(0, vertices.size(), [&](size_t i)
+            {
+                transform(m, vertices[i]);
+            });
+
+        printf("parallel_for, %2d workers: %6.2f ms/pass\n", workers, (scheduler_now() - start) / 1e6 / PASSES);
+    }
+
+    return 0;
+}
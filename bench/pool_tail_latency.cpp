@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "core/worker_thread.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace lemon;
+
+// Tasks submitted from outside the pool per measurement
+#define TASK_COUNT 4000
+// Workers of each scheduler
+#define WORKERS 8
+// One task in this many blocks for the long duration
+#define LONG_EVERY 200
+#define LONG_MS 20
+#define SHORT_US 20
+
+/**
+ * @brief Completion latencies of one measurement, in nanoseconds.
+ */
+struct latencies
+{
+    std::vector<long long> done = std::vector<long long>(TASK_COUNT);
+    std::atomic<int> remaining { TASK_COUNT };
+    long long total = 0;
+
+    void report(const char* name)
+    {
+        std::sort(this->done.begin(), this->done.end());
+        printf("%-14s total %6.1f ms, p50 %6.1f ms, p99 %6.1f ms, max %6.1f ms\n", name,
+            this->total / 1e6, this->done[TASK_COUNT / 2] / 1e6,
+            this->done[TASK_COUNT * 99 / 100] / 1e6, this->done.back() / 1e6);
+    }
+};
+
+/**
+ * @brief Submits the skewed workload and waits for every task to finish.
+ * @param submit Function which hands a task to the scheduler under test.
+ */
+template <typename S>
+void run(latencies& result, S&& submit)
+{
+    auto start = scheduler_now();
+
+    for (int i = 0; i < TASK_COUNT; i++)
+    {
+        auto submitted = scheduler_now();
+        submit([&result, i, submitted]()
+        {
+            if (i % LONG_EVERY == 0)
+                std::this_thread::sleep_for(std::chrono::milliseconds(LONG_MS));
+            else
+            {
+                auto until = scheduler_now() + SHORT_US * 1000;
+                while (scheduler_now() < until)
+                    ;
+            }
+
+            result.done[i] = scheduler_now() - submitted;
+            result.remaining.fetch_sub(1);
+        });
+    }
+
+    while (result.remaining.load() > 0)
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    result.total = scheduler_now() - start;
+}
+
+int main()
+{
+    printf("%d external tasks on %d workers; 1 in %d blocks %d ms, the rest spin %d us\n",
+        TASK_COUNT, WORKERS, LONG_EVERY, LONG_MS, SHORT_US);
+
+    {   /* ROUND-ROBIN ACROSS WORKER THREADS */
+        // Worker threads run until the process exits
+        std::vector<worker_thread*> workers;
+        for (int i = 0; i < WORKERS; i++)
+            workers.push_back(new worker_thread());
+
+        latencies result;
+        int next = 0;
+        run(result, [&](task job)
+        {
+            workers[next++ % WORKERS]->execute(std::move(job));
+        });
+        result.report("round-robin");
+    }
+
+    {   /* WORK-STEALING POOL */
+        worker_pool pool(WORKERS);
+
+        latencies result;
+        run(result, [&](task job)
+        {
+            pool.execute(std::move(job));
+        });
+        result.report("work-stealing");
+    }
+
+    fflush(stdout);
+    // Skip destruction of the still-running worker threads
+    _Exit(0);
+}
@@ -0,0 +1,87 @@
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "core/deque.h"
+#include "core/mpsc_queue.h"
+#include "core/scheduler_stats.h"
+#include "core/task.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace lemon;
+
+// Tasks pushed per measurement, split evenly across the producers
+#define TASK_COUNT 200000
+// Slots of the ring, matching a worker thread's lane
+#define RING_CAPACITY 1024
+
+/**
+ * Starts the producers together, each adding its share of empty tasks, while
+ * the calling thread consumes until every task has been polled.
+ *
+ * @brief Measures the time per task of one queue with several producers.
+ * @return Nanoseconds per task, from the first add to the last poll.
+ */
+template <typename Q>
+double measure(Q& queue, int producers)
+{
+    std::atomic<bool> go { false };
+    std::vector<std::thread> threads;
+
+    int share = TASK_COUNT / producers;
+    for (int p = 0; p < producers; p++)
+        threads.emplace_back([&]()
+        {
+            while (!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+
+            for (int i = 0; i < share; i++)
+                queue.add([]() { });
+        });
+
+    auto start = scheduler_now();
+    go.store(true, std::memory_order_release);
+
+    task next;
+    for (int polled = 0; polled < share * producers; )
+        if (queue.try_poll(next))
+            polled++;
+        else
+            std::this_thread::yield();
+
+    auto end = scheduler_now();
+    for (auto& thread : threads)
+        thread.join();
+
+    return (double)(end - start) / (share * producers);
+}
+
+int main()
+{
+    printf("%d empty tasks split across N producers into one consumer; ns per task\n", TASK_COUNT);
+    printf("%10s %10s %10s\n", "producers", "deque", "mpsc");
+
+    for (int producers = 1; producers <= 64; producers *= 2)
+    {
+        deque<task> locked;
+        auto ring = new mpsc_queue<task, RING_CAPACITY>();
+
+        auto locked_ns = measure(locked, producers);
+        auto ring_ns = measure(*ring, producers);
+        delete ring;
+
+        printf("%10d %10.1f %10.1f\n", producers, locked_ns, ring_ns);
+    }
+
+    return 0;
+}
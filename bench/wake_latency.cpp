@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "core/scheduler_stats.h"
+#include "core/worker_thread.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace lemon;
+
+// Tasks submitted per measurement
+#define TASK_COUNT 20000
+
+/**
+ * @brief Measures the latency from submitting a task to its start, with an
+ *      idle gap before each submission, and prints its percentiles.
+ */
+void measure(worker_thread& worker, const char* name, long long gap_ns)
+{
+    std::vector<long long> latencies;
+    latencies.reserve(TASK_COUNT);
+
+    for (int i = 0; i < TASK_COUNT; i++)
+    {
+        std::atomic<long long> started { 0 };
+        auto submitted = scheduler_now();
+
+        worker.execute([&started, submitted]()
+        {
+            started.store(scheduler_now() - submitted);
+        });
+        while (started.load() == 0)
+            std::this_thread::yield();
+        latencies.push_back(started.load());
+
+        // Leave the worker idle before the next submission
+        auto until = scheduler_now() + gap_ns;
+        while (scheduler_now() < until)
+            ;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    printf("%-8s gap %7.1f us: p50 %8lld ns, p99 %8lld ns\n", name, gap_ns / 1e3,
+        latencies[TASK_COUNT / 2], latencies[TASK_COUNT * 99 / 100]);
+}
+
+int main()
+{
+    printf("%d tasks per measurement, submit-to-start latency\n", TASK_COUNT);
+
+    // Worker threads run until the process exits
+    auto blocking = new worker_thread();
+    blocking->set_spin_limit(std::chrono::nanoseconds(0));
+    auto spinning = new worker_thread();
+
+    for (long long gap_ns : { 1000LL, 5000LL, 50000LL, 500000LL })
+    {
+        measure(*blocking, "block", gap_ns);
+        measure(*spinning, "spin", gap_ns);
+    }
+
+    fflush(stdout);
+    // Skip destruction of the still-running worker threads
+    _Exit(EXIT_SUCCESS);
+}
@@ -1,4 +1,5 @@
 #include "application.h"
+#include "profiler.h"
 
 #include <time.h>
 #include <chrono>
@@ -16,13 +17,11 @@
 
 // Define shortened names for convenience
 typedef std::chrono::high_resolution_clock high_res;
-typedef std::chrono::seconds sec;
 typedef std::chrono::nanoseconds nano;
 
 // Warning threshold for abnormal standard deviation
 #define STD_DEV_WARNING 17.0
 // Macros for calculating delta times between moments
-#define delta_sec(e, s) std::chrono::duration_cast<sec>(e - s).count()
 #define delta_nano(e, s) std::chrono::duration_cast<nano>(e - s).count()
 
 namespace lemon
@@ -37,20 +36,45 @@ namespace lemon
         int frame_count = 0;
         int update_time = 5;
 
-        // Frame-time and min/max states
+        // Frame-time states
         auto last_time = last_update;
-        double max = -1.0, min = -1.0;
         double delta = 0.0;
 
         // Standard deviation states
         double mean = 0.0, mean2 = 0.0;
         double variance = 0.0;
 
+        // Flag the statistics for logging from a timer, off the frame loop
+        auto report = this->pool.execute_every(std::chrono::seconds(update_time), [this]()
+        {
+            this->report_due = true;
+        });
+
         while (this->app_context->is_alive())
         {
+            LEMON_PROFILE_SCOPE("Frame");
+            auto cpu_start = scheduler_now();
+
+            try
+            {
+                // Deliver events which arrived since the previous frame
+                LEMON_PROFILE_SCOPE("Input");
+                input_event event;
+                while (this->app_context->poll_input(event))
+                {
+                    this->input_latency.record(scheduler_now() - event.time);
+                    this->input(event);
+                }
+            } catch(const std::exception& ex)
+            {
+                auto error = ex.what();
+                log.error(error);
+            }
+
             try
             {
                 // Run each frame
+                LEMON_PROFILE_SCOPE("Update");
                 this->update(delta);
             } catch(const std::exception& ex)
             {
@@ -58,21 +82,34 @@ namespace lemon
                 log.error(error);
             }
 
-            this->app_context->update();
+            try
+            {
+                // Run the frame's declared jobs across the pool
+                LEMON_PROFILE_SCOPE("Frame graph");
+                this->frame_graph.run(this->pool);
+            } catch(const std::exception& ex)
+            {
+                auto error = ex.what();
+                log.error(error);
+            }
+
+            auto context_start = scheduler_now();
+            {
+                LEMON_PROFILE_SCOPE("Context update");
+                this->app_context->update();
+            }
+            auto context_end = scheduler_now();
 
             {   /* FRAME COUNTING */
                 frame_count++;
                 auto time = high_res::now();
 
                 // Calculate frame time (nano) and frames per second
-                int frame_time = (int)delta_nano(time, last_time);
+                long long frame_time = delta_nano(time, last_time);
                 double frames = 1000000000.0 / frame_time;
                 delta = (double)frame_time / 1000000000.0;
-                // Compare to current min/max values
-                if (frames > max || max == -1.0)
-                    max = frames;
-                if (frames < min || min == -1.0)
-                    min = frames;
+                // Split the frame into application and context time
+                this->frame_times.record(frame_time, context_start - cpu_start, context_end - context_start);
                 // Update last time for next iteration
                 last_time = time;
 
@@ -83,40 +120,67 @@ namespace lemon
                 variance = mean2 / frame_count;
 
                 /* LOG OUTPUT */
-                if (delta_sec(time, last_update) >= update_time)
+                if (this->report_due.load(std::memory_order_relaxed) && this->report_due.exchange(false))
                 {
                     // Calculate average framerate over update period
-                    float rate = (float)frame_count / update_time;
+                    float rate = (float)(frame_count / (delta_nano(time, last_update) / 1000000000.0));
                     double percent_dev = sqrt(variance) / rate * 100;
 
-                    // Log colorful performance stats
-                    this->log.debug(std::to_string((int)rate) + " +/- "
-                        + std::to_string(percent_dev) + "% fps"
-                        + " (\033[1;31m" + std::to_string((int)min) + "\033[0;37m"
-                        + ", \033[1;32m" + std::to_string((int)max) + "\033[0;37m"
-                        + ")");
+                    // Log frame-time distribution, exporting it if enabled
+                    this->log.debug("{} +/- {}% fps", (int)rate, percent_dev);
+                    this->log.debug(this->frame_times.snapshot().describe());
+                    // Log the chain of jobs which bounds the frame graph
+                    if (!this->frame_graph.empty())
+                    {
+                        std::string path;
+                        for (auto& name : this->frame_graph.critical_path())
+                            path += (path.empty() ? "" : " -> ") + name;
+
+                        this->log.debug("Frame graph critical path: {} ({} of {} ms)", path,
+                            this->frame_graph.critical_time() * 1000.0, this->frame_graph.run_time() * 1000.0);
+                    }
+                    if (this->input_latency.total() > 0)
+                        this->log.debug("Input-to-update latency: p50 {} us, p99 {} us over {} events",
+                            this->input_latency.percentile(0.5) / 1000.0,
+                            this->input_latency.percentile(0.99) / 1000.0,
+                            this->input_latency.total());
+                    // Log scheduler telemetry for the same period
+                    this->log.debug(this->app_context->snapshot().describe());
+                    for (auto& worker : this->pool.snapshot())
+                        this->log.debug(worker.describe());
                     // Print warning if abnormally varied
                     if (percent_dev >= STD_DEV_WARNING)
-                        this->log.warn("Abnormal variation in frametimes detected; "
-                             + std::to_string(percent_dev)
-                             + "% is above the warning threshold");
+                        this->log.warn("Abnormal variation in frametimes detected; {}% is above the warning threshold",
+                            percent_dev);
 
                     // Reset timer for period
                     last_update = time;
                     // Reset states for next period
                     frame_count = 0;
-                    max = min = -1.0f;
                     mean = mean2 = variance = 0.0;
                 }
             }
         }
 
+        report.cancel();
+        // Summarize and export the final partial period
+        this->log.debug(this->frame_times.snapshot().describe());
         this->log.debug("App context has died on current thread");
         this->destroy();
         this->app_context.reset();
+
+        logger::flush();
+    }
+
+    void application::export_frame_stats(std::string path)
+    {
+        if (this->frame_times.export_to(path))
+            this->log.info("Exporting frame-time statistics to {}", path);
+        else
+            this->log.warn("Could not open {} to export frame-time statistics", path);
     }
 
-    application::application(std::shared_ptr<extension> ext)
+    application::application(std::shared_ptr<extension> ext, worker_pool& pool) : pool(pool)
     {
         this->ext = ext;
 
@@ -124,6 +188,7 @@ namespace lemon
         log.debug("Starting application on dedicated thread");
         this->app_thread.execute([=, this]()
         {
+            profiler::name_thread("Application thread");
             log.debug("Active on dedicated thread; looping until context dies");
             this->start();
         });
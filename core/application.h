@@ -6,6 +6,8 @@
 #include "worker_thread.h"
 #include "logger.h"
 #include "extension.h"
+#include "frame_stats.h"
+#include "task_graph.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 //                          Lemon 3D Graphics Engine                          //
@@ -56,6 +58,24 @@ namespace lemon
              */
             void start();
 
+            /**
+             * @brief Set periodically by a pool timer when frame statistics
+             *      are due to be logged.
+             */
+            std::atomic<bool> report_due { false };
+
+            /**
+             * @brief Time from capture of each input event until it is
+             *      delivered to the application at the start of a frame.
+             */
+            latency_histogram input_latency;
+
+            /**
+             * @brief Distribution of frame, application and context times,
+             *      summarized with each statistics report.
+             */
+            frame_stats frame_times;
+
         protected:
             /**
              * This graphical context provides asset instances and performs
@@ -81,13 +101,45 @@ namespace lemon
         
             std::shared_ptr<extension> ext;
 
+            /**
+             * @brief Pool which runs the frame graph and statistics timer; it
+             *      must outlive the application.
+             */
+            worker_pool& pool;
+
+            /**
+             * Jobs declared in this graph (typically during setup) are run on
+             * the application's worker pool every frame, after `update` and before
+             * the context update.  Independent jobs run concurrently, and the
+             * critical path of the graph is logged with the frame statistics.
+             * 
+             * @brief Per-frame jobs and their dependencies.
+             */
+            task_graph frame_graph;
+
+            /**
+             * Each periodic frame-time summary, and a final one for the end of
+             * the run, is appended as a row; see `frame_stats::export_to`.
+             * Call from `setup`, which runs on the application thread.
+             *
+             * @brief Exports frame-time statistics of this run to a CSV file, or
+             *      a JSON file if the path ends in ".json".
+             * @param path File to create or overwrite.
+             */
+            void export_frame_stats(std::string path);
+
             /**
              * @brief Application-management-specific logger instance.
              */
             logger log { "Application" };
 
         public:
-            application(std::shared_ptr<extension> ext);
+            /**
+             * @brief Starts the application on its dedicated thread.
+             * @param ext Extension which creates the application's context.
+             * @param pool Worker pool on which per-frame jobs are run.
+             */
+            application(std::shared_ptr<extension> ext, worker_pool& pool);
 
             virtual void setup()
             { }
@@ -95,6 +147,14 @@ namespace lemon
             virtual void update(double delta)
             { }
 
+            /**
+             * @brief Receives each window or input event, in order, at the start
+             *      of the frame following its arrival.
+             * @param event The window or input event.
+             */
+            virtual void input(const input_event& event)
+            { }
+
             virtual void destroy()
             { }
     };
@@ -5,6 +5,7 @@
 #include "ext_opengl/gl_program.h"
 #include "ext_glfw/ext_glfw.h"
 
+#include <cstdlib>
 #include <iostream>
 #include <thread>
 #include <filesystem>
@@ -12,6 +13,7 @@
 
 #include "application.h"
 #include "logger.h"
+#include "profiler.h"
 #include "worker_thread.h"
 #include "resource.h"
 #include "static_mesh.h"
@@ -27,6 +29,8 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #define EXT std::shared_ptr<extension>(new ext_opengl(4, 6, true, true))
+// Mesh blocks recorded into each command list by a single pool task
+#define RECORD_BLOCKS_PER_LIST 64
 
 namespace lemon
 {
@@ -73,24 +77,172 @@ namespace lemon
             std::shared_ptr<shader_program> shader;
             std::shared_ptr<shader_buffer> bodies;
             std::vector<std::shared_ptr<shader_buffer>> blocks;
+            /**
+             * @brief Blocks drawn by the frame being recorded, copied from the
+             *      render list so that recording holds no lock.  Recorded
+             *      commands keep the blocks they bind alive until replayed.
+             */
+            std::vector<std::shared_ptr<shader_buffer>> drawn;
+
+            /**
+             * @brief Uploads a filled mesh block and adds it to the render list.
+             * @param data Vertex data of the mesh block.
+             */
+            coroutine<> upload_block(render_data* data)
+            {
+                // Create and fill the buffer from the context thread, within
+                // the low-priority lane's per-frame budget
+                co_await app_context->on_thread(task_priority::low);
+                LEMON_PROFILE_SCOPE("Upload mesh block");
+
+                auto block = ext->create_buffer(app_context, 0);
+                block->put(data, sizeof(render_data));
+
+                std::lock_guard<std::mutex> lock(blocks_mut);
+                blocks.push_back(block);
+            }
+
+            /**
+             * Parses the provided OBJ file into mesh blocks, hopping between
+             * the primary pool (parsing) and the context thread (uploading
+             * each filled block).  No thread is blocked waiting on another.
+             * 
+             * @brief Loads a model file into the render list asynchronously.
+             * @param fname Path of the OBJ model file to load.
+             */
+            coroutine<> load_model(std::string fname)
+            {
+                co_await primary_pool.schedule();
+                // Ended across each suspension, as parsing may resume elsewhere
+                profile_scope parsing("Parse OBJ");
+
+                const float heuristic = 0.03575f * 1.25f;
+                long long model_size = std::filesystem::file_size(fname);
+
+                {
+                    std::lock_guard<std::mutex> lock(blocks_mut);
+                    blocks.clear();
+                }
+
+                static logger log("OBJ Loader");
+
+                std::vector<vec3> vertices;
+                vertices.reserve((int)(model_size * heuristic));
+                std::vector<vec3> vertex_normals;
+                vertex_normals.reserve((int)(model_size * heuristic));
+
+                log.debug("Reserving heuristic buffer of {} vertices", vertices.capacity());
+
+                render_data* current = new render_data;
+                int i = 0, num_blocks = 0;
+
+                std::vector<std::string> elements, sub_elements;
+                vec3 arr;
+
+                for (auto& line : read_lines(fname))
+                {
+                    if (line.size() == 0)
+                        continue;
+
+                    elements.clear();
+                    split_string(line, " ", elements);
+
+                    switch (line[0])
+                    {
+                        case 'v':
+                            arr.x = strtof(elements[1].c_str(), NULL);
+                            arr.y = strtof(elements[2].c_str(), NULL);
+                            arr.z = strtof(elements[3].c_str(), NULL);
+
+                            if (line[1] == 'n')
+                                vertex_normals.push_back(arr);
+                            else
+                                vertices.push_back(vec3
+                                {
+                                    arr.x, arr.y, arr.z
+                                });
+                            break;
+
+                        case 'f':
+                            if (i == MESH_BLOCK_SIZE)
+                            {
+                                log.debug("Allocating next mesh block of {} vertices", MESH_BLOCK_SIZE);
+
+                                // Upload the filled block, then resume parsing
+                                parsing.end();
+                                co_await upload_block(current);
+                                co_await primary_pool.schedule();
+                                parsing.begin();
+                                num_blocks++;
+
+                                current = new render_data;
+                                i = 0;
+                            }
+
+                            for (int j = 0; j < 3; j++)
+                            {
+                                sub_elements.clear();
+                                split_string(elements[j + 1], "/", sub_elements);
+
+                                auto vert = vertices[strtol(sub_elements[0].c_str(), NULL, 10) - 1];
+                                auto norm = vertex_normals[strtol(sub_elements[2].c_str(), NULL, 10) - 1];
+
+                                current->vertices[i++] =
+                                {
+                                    .position = { vert.x, vert.y, vert.z, 1.0f },
+                                    .diffuse = { 1.0f, 1.0f, 1.0f, 1.0f },
+                                    .normal_vector = { norm.x,  norm.y,  norm.z }, 
+                                    .texture_coord = { 0.0f,  1.0f },
+                                    .body_index = { 0U }
+                                };
+                            }
+                    }
+                }
+
+                log.info("Mesh loaded with {} vertices ({} allocated blocks)",
+                    num_blocks * MESH_BLOCK_SIZE + i, num_blocks + 1);
+
+                // Upload the last unfilled block
+                parsing.end();
+                current->num_vertices = i;
+                co_await upload_block(current);
+            }
+
+            /**
+             * @brief Stops profiling and writes the profile to the path in
+             *      `LEMON_PROFILE`, or to "lemon_profile.json".
+             */
+            void write_profile()
+            {
+                auto path = std::getenv("LEMON_PROFILE");
+                if (profiler::stop(path ? path : "lemon_profile.json"))
+                    log.info("Wrote profile to {}", path ? path : "lemon_profile.json");
+                else
+                    log.warn("Could not write profile to {}", path ? path : "lemon_profile.json");
+            }
 
         public:
-            bootstrap() : application(EXT)
+            bootstrap() : application(EXT, primary_pool)
             { }
 
             void setup()
             {
+                // Export frame-time statistics of the run if requested
+                if (auto path = std::getenv("LEMON_FRAME_STATS"))
+                    this->export_frame_stats(path);
+
                 // Load basic shader program GLSL sources
                 auto src_vert = read_file("shaders/default.vert");
                 auto src_frag = read_file("shaders/default.frag");
                 shader = ext->create_program(app_context, src_vert, src_frag);
 
                 // Bind a default vertex array (required)
-                app_context->perform([]()
+                auto gl = static_cast<gl_context*>(app_context.get());
+                app_context->perform([gl]()
                 {
                     GLuint vertex_array;
                     glGenVertexArrays(1, &vertex_array);
-                    glBindVertexArray(vertex_array);
+                    gl->state().bind_vertex_array(vertex_array);
                 });
 
                 bodies = ext->create_buffer(app_context, 1);
@@ -114,146 +266,83 @@ namespace lemon
                     };
                 });
 
-                primary_pool.execute([&]()
-                {
-                    std::string fname = "models/xyzrgb_dragon.obj";
-                    const float heuristic = 0.03575f * 1.25f;
-                    long long model_size = std::filesystem::file_size(fname);
+                // Keep streaming uploads from delaying frame presentation
+                app_context->set_budget(task_priority::low, std::chrono::milliseconds(4));
+                // Parse the model on the pool while rendering continues
+                this->load_model("models/xyzrgb_dragon.obj").detach();
 
-                    blocks_mut.lock(); //TODO
-                    blocks.clear();
-                    blocks_mut.unlock();
+            }
 
-                    static logger log("OBJ Loader");
+            void update(double delta)
+            {
+                // Record the frame's commands to submit as one task; not yet
+                // abstracted
+                auto gl = static_cast<gl_context*>(app_context.get());
+                auto commands = gl->record();
 
-                    std::vector<vec3> vertices;
-                    vertices.reserve((int)(model_size * heuristic));
-                    std::vector<vec3> vertex_normals;
-                    vertex_normals.reserve((int)(model_size * heuristic));
+                // Prepare each frame for rendering (viewport, depth buffer)
+                commands->viewport(0, 0, 1400, 900);
+                commands->clear_color(0.1f, 0.06f, 0.0f, 1.0f);
 
-                    log.debug("Reserving heuristic buffer of "
-                        + std::to_string(vertices.capacity())
-                        + " vertices");
+                commands->enable(GL_DEPTH_TEST);
+                commands->clear(GL_DEPTH_BUFFER_BIT);
 
-                    render_data* current = new render_data;
-                    int i = 0;
+                commands->uniform(1, "time", (float)glfwGetTime());
 
-                    read_file(fname, false, [&](std::string line)
-                    {
-                        if (line.size() > 0)
-                        {
-                            std::vector<std::string> elements, sub_elements;
-                            split_string(line, " ", elements);
+                // Render each model mesh block, recording ranges of blocks into
+                // separate lists across the pool; ranges depend only on the
+                // number of blocks, so the submitted order is deterministic
+                {
+                    std::lock_guard<std::mutex> lock(blocks_mut);
+                    drawn.assign(blocks.begin(), blocks.end());
+                }
+                auto ranges = (drawn.size() + RECORD_BLOCKS_PER_LIST - 1) / RECORD_BLOCKS_PER_LIST;
 
-                            vec3 arr;
+                std::vector<std::unique_ptr<gl_command_buffer>> lists;
+                lists.push_back(std::move(commands));
+                for (size_t i = 0; i < ranges; i++)
+                    lists.push_back(gl->record());
 
-                            switch (line[0])
-                            {
-                                case 'v':
-                                    arr.x = strtof(elements[1].c_str(), NULL);
-                                    arr.y = strtof(elements[2].c_str(), NULL);
-                                    arr.z = strtof(elements[3].c_str(), NULL);
-
-                                    if (line[1] == 'n')
-                                        vertex_normals.push_back(arr);
-                                    else
-                                        vertices.push_back(vec3
-                                        {
-                                            arr.x, arr.y, arr.z
-                                        });
-                                    break;
-
-                                case 'f':
-                                    if (current == nullptr || i == MESH_BLOCK_SIZE)
-                                    {
-                                        log.debug("Allocating next mesh block of "
-                                            + std::to_string(MESH_BLOCK_SIZE)
-                                            + " vertices");
-
-                                        // if (blocks.size() > 0)
-                                        //     blocks.back()->unmap();
-
-                                        blocks.push_back(ext->create_buffer(app_context, 0));
-                                        blocks.back()->put(current, sizeof(render_data));
-
-                                        current = new render_data;//blocks.back()->map_typed<render_data>(true, true);
-
-                                        i = 0;
-                                    }
-
-                                    for (int j = 0; j < 3; j++)
-                                    {
-                                        sub_elements.clear();
-                                        split_string(elements[j + 1], "/", sub_elements);
-
-                                        auto vert = vertices[strtol(sub_elements[0].c_str(), NULL, 10) - 1];
-                                        auto norm = vertex_normals[strtol(sub_elements[2].c_str(), NULL, 10) - 1];
-
-                                        current->vertices[i++] =
-                                        {
-                                            .position = { vert.x, vert.y, vert.z, 1.0f },
-                                            .diffuse = { 1.0f, 1.0f, 1.0f, 1.0f },
-                                            .normal_vector = { norm.x,  norm.y,  norm.z }, 
-                                            .texture_coord = { 0.0f,  1.0f },
-                                            .body_index = { 0U }
-                                        };
-                                    }
-                            }
-                        }
-                    });
-
-                    log.info("Mesh loaded with "
-                        + std::to_string((blocks.size() - 1) * MESH_BLOCK_SIZE + i)
-                        + " vertices ("
-                        + std::to_string(blocks.size())
-                        + " allocated blocks)");
-                    
-                    // Unmap the last unfilled buffer if there is one
-                    if (blocks.size() > 0)
+                primary_pool.parallel_for(0, ranges, [&](size_t range)
+                {
+                    LEMON_PROFILE_SCOPE("Record blocks");
+                    auto& list = *lists[range + 1];
+
+                    // Bodies use their own binding point, so bind them once per list
+                    static_cast<gl_ssbo*>(bodies.get())->bind_base(list);
+
+                    auto end = std::min(drawn.size(), (range + 1) * RECORD_BLOCKS_PER_LIST);
+                    for (auto i = range * RECORD_BLOCKS_PER_LIST; i < end; i++)
                     {
-                        current->num_vertices = i;
-                        //blocks.back()->unmap();
+                        static_cast<gl_ssbo*>(drawn[i].get())->bind_base(list);
 
-                        blocks.push_back(ext->create_buffer(app_context, 0));
-                        blocks.back()->put(current, sizeof(render_data));
+                        list.draw_arrays(GL_TRIANGLES, 0, MESH_BLOCK_SIZE);
                     }
+                }, 1);
 
-                    //std::this_thread::sleep_for(std::chrono::seconds(10));
-                });
-
+                gl->submit(std::move(lists));
             }
 
-            void update(double delta)
+            void input(const input_event& event)
             {
-                // Prepare each frame for rendering (viewport, depth buffer)
-                app_context->perform([]()
-                {
-                    glViewport(0, 0, 1400, 900);
-                    glClearColor(0.1f, 0.06f, 0.0f, 1.0f);
+                // Toggle profiling with F9; stopping writes the profile
+                if (event.type != input_type::key || event.code != GLFW_KEY_F9 || event.action != GLFW_PRESS)
+                    return;
 
-                    glEnable(GL_DEPTH_TEST);
-                    glClear(GL_DEPTH_BUFFER_BIT);
-
-                    glUniform1f(glGetUniformLocation(1, "time"), (float)glfwGetTime());
-                });
-
-                // Render each model mesh block; not yet abstracted
-                blocks_mut.lock();
-                for (int i = 0; i < blocks.size(); i++)
+                if (profiler::running())
+                    this->write_profile();
+                else
                 {
-                    static_cast<gl_ssbo*>(blocks[i].get())->bind_base();
-                    static_cast<gl_ssbo*>(bodies.get())->bind_base();
-
-                    app_context->perform([]()
-                    {
-                        glDrawArrays(GL_TRIANGLES, 0, MESH_BLOCK_SIZE);
-                    });
+                    profiler::start();
+                    log.info("Profiling; press F9 again to write the profile");
                 }
-                blocks_mut.unlock();
             }
 
             void destroy()
             {
+                if (profiler::running())
+                    this->write_profile();
+
                 this->blocks.clear();
 
                 this->bodies.reset();
@@ -276,8 +365,19 @@ namespace lemon
  */
 int main()
 {
+    // Keep terminal output off the render and worker threads
+    lemon::logger::start_async(lemon::log_overflow::count);
+    // Soak tests write a binary trace log, decoded offline, instead of text
+    if (auto path = std::getenv("LEMON_TRACE_LOG"))
+        lemon::logger::start_trace(path);
+
     static lemon::logger log("(Bootstrap)");
 
+    // Profile from launch if a profile path is provided
+    lemon::profiler::name_thread("Main thread");
+    if (std::getenv("LEMON_PROFILE"))
+        lemon::profiler::start();
+
     log.info("\033[1;33m===============================================================");
     log.info("                 \033[1;31mLemon\033[0m created by \033[1;31mZach Goethel");
     log.info("\033[1;33m===============================================================");
@@ -1,5 +1,9 @@
 #include "context.h"
 
+#include <algorithm>
+
+#include "profiler.h"
+
 ////////////////////////////////////////////////////////////////////////////////
 //                          Lemon 3D Graphics Engine                          //
 //                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
@@ -12,12 +16,69 @@
 
 namespace lemon
 {
-    void context::perform(std::function<void()> task, bool wait)
+    context::context()
+    {
+        this->thread.name_tasks("Context perform");
+        this->thread.execute([]()
+        {
+            profiler::name_thread("Context thread");
+        });
+    }
+
+    void context::perform(task task, bool wait, task_priority priority)
     {
         // Queue directly to worker thread
-        if (wait)
-            this->thread.execute_wait(task);
+        if (wait || this->thread.is_current())
+            // Runs inline when already on the context thread
+            this->thread.execute_wait(std::move(task), priority);
         else
-            this->thread.execute(task);
+            this->thread.execute(std::move(task), priority);
+    }
+
+    void context::submit_frame(task present)
+    {
+        int in_flight = this->frames_in_flight.load();
+
+        {
+            LEMON_PROFILE_SCOPE("Frame wait");
+            std::unique_lock<std::mutex> lock(this->frame_mutex);
+
+            // Wait for a frame slot; the context thread can not wait on frames
+            // queued behind itself
+            if (!this->thread.is_current())
+                this->frame_presented.wait(lock, [&]()
+                {
+                    return this->frames_submitted - this->frames_presented < (uint64_t)std::max(in_flight, 1);
+                });
+
+            this->frames_submitted++;
+        }
+
+        this->perform([this, present = std::move(present)]() mutable
+        {
+            present();
+
+            // Notify under the lock, as waiters may destroy the context
+            std::lock_guard<std::mutex> lock(this->frame_mutex);
+            this->frames_presented++;
+            this->frame_presented.notify_all();
+        }, in_flight == 0);
+    }
+
+    void context::wait_frames()
+    {
+        if (this->thread.is_current())
+            return;
+
+        std::unique_lock<std::mutex> lock(this->frame_mutex);
+        this->frame_presented.wait(lock, [this]()
+        {
+            return this->frames_presented == this->frames_submitted;
+        });
+    }
+
+    void context::perform_batch(task* tasks, size_t count)
+    {
+        this->thread.execute_batch(tasks, count);
     }
 }
\ No newline at end of file
@@ -1,9 +1,16 @@
 #pragma once
 
-#include <functional>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 
 #include "worker_thread.h"
+#include "input.h"
+
+// Frames the application may submit before the context has presented them
+#ifndef CONTEXT_FRAMES_IN_FLIGHT
+    #define CONTEXT_FRAMES_IN_FLIGHT 2
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////
 //                          Lemon 3D Graphics Engine                          //
@@ -60,8 +67,52 @@ namespace lemon
              * @brief Dedicated thread in which the context can stay active.
              */
             worker_thread thread;
+
+            /**
+             * @brief Guards the frame counters; signalled whenever a frame has
+             *      been presented.
+             */
+            std::mutex frame_mutex;
+            std::condition_variable frame_presented;
+
+            /**
+             * @brief Frames submitted to and presented by the context thread.
+             */
+            uint64_t frames_submitted = 0;
+            uint64_t frames_presented = 0;
+
+            /**
+             * @brief Submitted frames which may await presentation at once.
+             */
+            std::atomic<int> frames_in_flight { CONTEXT_FRAMES_IN_FLIGHT };
         
+        protected:
+            /**
+             * Frames are pipelined: the application builds the next frame
+             * while the context thread presents earlier ones.  This waits only
+             * until fewer than the allowed number of frames are in flight, and
+             * then queues the presentation without waiting for it.  With zero
+             * frames in flight, it waits for the frame to be presented.
+             * 
+             * @brief Queues the task which presents a frame; to be called by
+             *      implementations' `update`.
+             * @param present Context-related task which presents the frame.
+             */
+            void submit_frame(task present);
+
+            /**
+             * @brief Restores the per-frame budget of each priority lane; to be
+             *      called by implementations from the context thread once per
+             *      presented frame.
+             */
+            void begin_frame()
+            {
+                this->thread.begin_frame();
+            }
+
         public:
+            context();
+
             /**
              * Enqueues a context-related task to be performed on the context's
              * dedicated thread.  This method's implementation must be thread-
@@ -77,12 +128,140 @@ namespace lemon
              * specific order (or must be executed together) should be grouped
              * together into a single submitted task.
              * 
+             * Tasks performed from the context's own thread run immediately,
+             * within the task (and priority lane) which performs them.
+             * 
              * @brief Runs a task related to this context within this context.
              * @param task Context-related task to enqueue for execution from
              *      the context's dedicated thread.
              * @param wait Whether or not the call should hang until complete.
+             * @param priority Lane in which the task is queued, also when
+             *      waiting; low-priority work such as resource streaming should
+             *      not delay frames.
+             */
+            void perform(task task, bool wait = false, task_priority priority = task_priority::normal);
+
+            /**
+             * Enqueues several context-related tasks to be performed in order
+             * on the context's dedicated thread.  The batch is submitted with
+             * a single queue reservation and at most one thread wakeup, which
+             * amortizes submission costs for many small tasks.
+             * 
+             * @brief Runs several tasks related to this context in order.
+             * @param tasks Array of tasks to enqueue; each is left empty.
+             * @param count Number of tasks in the array.
+             */
+            void perform_batch(task* tasks, size_t count);
+
+            /**
+             * Enqueues a context-related task like `perform` without waiting,
+             * returning a future of the task's result.  Continuations attached
+             * to the future may then run on the context or on a worker pool,
+             * so that creation of context objects can be pipelined.
+             * 
+             * @brief Runs a task within this context and returns its result.
+             * @param fn Context-related function returning a result.
+             * @return Future of the value returned by the function.
+             */
+            template <typename F>
+            auto perform_async(F&& fn)
+            {
+                return this->thread.execute_async(std::forward<F>(fn));
+            }
+
+            /**
+             * Context threads are latency-sensitive; pinning one to an isolated
+             * processor (and reserving that processor in the worker pool's
+             * placement) keeps the scheduler from migrating it and thrashing
+             * its caches.
+             * 
+             * @brief Pins the context's dedicated thread to logical processors.
+             * @param cpus Indices of the logical processors to run on.
+             */
+            void pin(std::vector<int> cpus)
+            {
+                this->thread.pin(std::move(cpus));
+            }
+
+            /**
+             * Awaited from a coroutine to continue its execution on this
+             * context's dedicated thread, where context-related calls can be
+             * made directly.  A coroutine suspended here does not block any
+             * thread while it waits in the context's queue.
+             * 
+             * @brief Creates an awaitable which resumes on the context thread.
+             * @param priority Lane in which the coroutine is queued.
+             * @return Awaitable to `co_await` upon.
+             */
+            thread_awaiter on_thread(task_priority priority = task_priority::normal)
+            {
+                return this->thread.schedule(priority);
+            }
+
+            /**
+             * Limits how long tasks of a lane may run on the context thread per
+             * frame, so that background work (such as streaming uploads) does
+             * not push a frame past its presentation deadline.  Frames are
+             * delimited by the context implementation's `update`.
+             * 
+             * @brief Sets the per-frame execution budget of a priority lane.
+             * @param priority Lane to limit.
+             * @param budget Execution time per frame; zero removes the limit.
+             */
+            void set_budget(task_priority priority, std::chrono::nanoseconds budget)
+            {
+                this->thread.set_budget(priority, budget);
+            }
+
+            /**
+             * @brief Enqueues a task on the context's thread without waiting;
+             *      allows a context to act as the executor of a continuation.
+             * @param task Context-related task to enqueue for execution.
+             */
+            void execute(task task)
+            {
+                this->perform(std::move(task));
+            }
+
+            /**
+             * More frames in flight hide more of the context thread's time
+             * behind the application's, at the cost of that many frames of
+             * added latency between input and presentation.
+             * 
+             * @brief Sets how many submitted frames may await presentation.
+             * @param frames Frames in flight; zero presents each frame before
+             *      `update` returns, as a fully synchronous context would.
+             */
+            void set_frames_in_flight(int frames)
+            {
+                this->frames_in_flight.store(frames < 0 ? 0 : frames);
+            }
+
+            /**
+             * @brief Waits until every submitted frame has been presented.
+             */
+            void wait_frames();
+
+            /**
+             * @brief Summarizes activity of the context's dedicated thread
+             *      since the previous snapshot; see `scheduler_stats`.
+             */
+            scheduler_snapshot snapshot()
+            {
+                return this->thread.snapshot("Context thread");
+            }
+
+            /**
+             * Window and input events are buffered as they arrive and drained
+             * by the application once per frame.  Only one thread may poll a
+             * context's events.
+             * 
+             * @brief Removes the oldest buffered window or input event.
+             * @param event Receives the removed event.
+             * @return Whether an event was available.
              */
-            void perform(std::function<void()> task, bool wait = false);
+            virtual bool poll_input(input_event& event)
+            { return false; }
 
             /**
              * @brief Updates the context, swaps the framebuffer, and polls input.
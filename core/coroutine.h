@@ -0,0 +1,344 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+#include "future.h"
+#include "logger.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace lemon
+{
+    /**
+     * Awaiting this object suspends the coroutine and enqueues its resumption
+     * as a task on the executor (a worker thread, worker pool or context), so
+     * the remainder of the coroutine runs there.  No thread is blocked while
+     * the coroutine waits in the executor's queue.
+     *
+     * @brief Awaitable which moves a coroutine onto the provided executor.
+     * @author Zach Goethel
+     */
+    template <typename E>
+    struct schedule_awaiter
+    {
+        E& executor;
+
+        /**
+         * @brief Set when the coroutine already runs on the executor.
+         */
+        bool already_there = false;
+
+        bool await_ready()
+        { return already_there; }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            executor.execute([handle]()
+            {
+                handle.resume();
+            });
+        }
+
+        void await_resume()
+        { }
+    };
+
+    /**
+     * @brief Storage of a coroutine's return value or thrown error.
+     */
+    template <typename T>
+    struct coroutine_result
+    {
+        std::optional<T> value;
+        std::exception_ptr error;
+
+        void return_value(T result)
+        { value.emplace(std::move(result)); }
+
+        T take()
+        {
+            if (error)
+                std::rethrow_exception(error);
+            return std::move(*value);
+        }
+    };
+
+    template <>
+    struct coroutine_result<void>
+    {
+        std::exception_ptr error;
+
+        void return_void()
+        { }
+
+        void take()
+        {
+            if (error)
+                std::rethrow_exception(error);
+        }
+    };
+
+    /**
+     * A lazily started asynchronous function.  The body does not run until
+     * the coroutine is awaited by another coroutine, detached, or started for
+     * a future result.  Within the body, await `worker_pool::schedule`,
+     * `worker_thread::schedule` or `context::on_thread` to hop between
+     * threads without blocking any of them.
+     *
+     * When awaited, the awaiting coroutine resumes on whichever thread the
+     * awaited coroutine finished on.
+     *
+     * @brief Asynchronous function which can move between Lemon threads.
+     * @author Zach Goethel
+     */
+    template <typename T = void>
+    class coroutine
+    {
+        public:
+            struct promise_type : coroutine_result<T>
+            {
+                /**
+                 * @brief Coroutine to resume once this one completes.
+                 */
+                std::coroutine_handle<> continuation;
+
+                /**
+                 * @brief Set if no handle owns the frame; it frees itself.
+                 */
+                bool detached = false;
+
+                /**
+                 * @brief Optional receiver of the result when started.
+                 */
+                std::optional<promise<T>> receiver;
+
+                coroutine get_return_object()
+                { return coroutine(std::coroutine_handle<promise_type>::from_promise(*this)); }
+
+                std::suspend_always initial_suspend() noexcept
+                { return { }; }
+
+                struct final_awaiter
+                {
+                    bool await_ready() noexcept
+                    { return false; }
+
+                    std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+                    {
+                        auto& p = handle.promise();
+                        if (p.continuation)
+                            return p.continuation;
+
+                        if (p.detached)
+                        {
+                            if (p.receiver)
+                                p.receiver->fulfill([&p]() { return p.take(); });
+                            else if (p.error)
+                            {
+                                static logger log("Coroutine");
+                                try
+                                {
+                                    std::rethrow_exception(p.error);
+                                } catch(const std::exception& ex)
+                                {
+                                    log.error(ex.what());
+                                } catch(...)
+                                {
+                                    log.error("Detached coroutine failed with an unknown error");
+                                }
+                            }
+
+                            handle.destroy();
+                        }
+
+                        return std::noop_coroutine();
+                    }
+
+                    void await_resume() noexcept
+                    { }
+                };
+
+                final_awaiter final_suspend() noexcept
+                { return { }; }
+
+                void unhandled_exception()
+                { this->error = std::current_exception(); }
+            };
+
+        private:
+            std::coroutine_handle<promise_type> handle;
+
+            explicit coroutine(std::coroutine_handle<promise_type> handle) : handle(handle)
+            { }
+
+        public:
+            coroutine(coroutine&& other) noexcept : handle(std::exchange(other.handle, nullptr))
+            { }
+
+            coroutine(const coroutine&) = delete;
+            coroutine& operator=(const coroutine&) = delete;
+
+            ~coroutine()
+            {
+                if (handle)
+                    handle.destroy();
+            }
+
+            /**
+             * @brief Runs the coroutine on the current thread until its first
+             *      suspension, after which it frees itself upon completion.
+             */
+            void detach() &&
+            {
+                auto h = std::exchange(handle, nullptr);
+                h.promise().detached = true;
+                h.resume();
+            }
+
+            /**
+             * @brief Detaches the coroutine, delivering its result to a future.
+             * @return Future of the coroutine's result.
+             */
+            future<T> start() &&
+            {
+                auto& p = handle.promise();
+                p.receiver.emplace();
+                auto result = p.receiver->get_future();
+
+                std::move(*this).detach();
+                return result;
+            }
+
+            bool await_ready()
+            { return false; }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting)
+            {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            T await_resume()
+            { return handle.promise().take(); }
+    };
+
+    /**
+     * A lazily evaluated sequence produced with `co_yield`.  Values are
+     * generated on the iterating thread, one at a time, as the generator is
+     * advanced.
+     *
+     * @brief Synchronous coroutine which yields a sequence of values.
+     * @author Zach Goethel
+     */
+    template <typename T>
+    class generator
+    {
+        public:
+            struct promise_type
+            {
+                T* current = nullptr;
+                std::exception_ptr error;
+
+                generator get_return_object()
+                { return generator(std::coroutine_handle<promise_type>::from_promise(*this)); }
+
+                std::suspend_always initial_suspend() noexcept
+                { return { }; }
+
+                std::suspend_always final_suspend() noexcept
+                { return { }; }
+
+                std::suspend_always yield_value(T& value) noexcept
+                {
+                    current = &value;
+                    return { };
+                }
+
+                std::suspend_always yield_value(T&& value) noexcept
+                {
+                    current = &value;
+                    return { };
+                }
+
+                void return_void()
+                { }
+
+                void unhandled_exception()
+                { error = std::current_exception(); }
+            };
+
+            struct sentinel
+            { };
+
+            class iterator
+            {
+                friend class generator;
+
+                private:
+                    std::coroutine_handle<promise_type> handle;
+
+                    explicit iterator(std::coroutine_handle<promise_type> handle) : handle(handle)
+                    { }
+
+                    void _advance()
+                    {
+                        handle.resume();
+                        if (handle.promise().error)
+                            std::rethrow_exception(handle.promise().error);
+                    }
+
+                public:
+                    iterator& operator++()
+                    {
+                        this->_advance();
+                        return *this;
+                    }
+
+                    T& operator*() const
+                    { return *handle.promise().current; }
+
+                    bool operator==(sentinel) const
+                    { return handle.done(); }
+            };
+
+        private:
+            std::coroutine_handle<promise_type> handle;
+
+            explicit generator(std::coroutine_handle<promise_type> handle) : handle(handle)
+            { }
+
+        public:
+            generator(generator&& other) noexcept : handle(std::exchange(other.handle, nullptr))
+            { }
+
+            generator(const generator&) = delete;
+            generator& operator=(const generator&) = delete;
+
+            ~generator()
+            {
+                if (handle)
+                    handle.destroy();
+            }
+
+            iterator begin()
+            {
+                iterator it(handle);
+                it._advance();
+                return it;
+            }
+
+            sentinel end()
+            { return { }; }
+    };
+}
\ No newline at end of file
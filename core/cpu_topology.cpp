@@ -0,0 +1,265 @@
+#include "cpu_topology.h"
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <thread>
+
+#ifdef _WIN32
+    #include <windows.h>
+#elif __linux__
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+#define SYSFS_CPU "/sys/devices/system/cpu/"
+#define SYSFS_NODE "/sys/devices/system/node/"
+
+namespace lemon
+{
+    /**
+     * @brief Parses a kernel CPU list ("0-3,8-11") into processor indices.
+     */
+    std::vector<int> _parse_cpu_list(std::string list)
+    {
+        std::vector<int> cpus;
+        size_t pos = 0;
+
+        while (pos < list.size())
+        {
+            auto comma = list.find(',', pos);
+            if (comma == std::string::npos)
+                comma = list.size();
+            auto item = list.substr(pos, comma - pos);
+            pos = comma + 1;
+
+            if (item.empty())
+                continue;
+            auto dash = item.find('-');
+            int first = std::stoi(item.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+
+            for (int i = first; i <= last; i++)
+                cpus.push_back(i);
+        }
+
+        return cpus;
+    }
+
+    /**
+     * @brief Reads the first line of a sysfs file, or an empty string.
+     */
+    std::string _read_line(std::string path)
+    {
+        std::ifstream input(path);
+        std::string line;
+
+        if (input.is_open())
+            getline(input, line);
+        return line;
+    }
+
+    const cpu_topology& cpu_topology::system()
+    {
+        static cpu_topology topology = []()
+        {
+            cpu_topology result;
+
+            auto online = _parse_cpu_list(_read_line(SYSFS_CPU "online"));
+            if (online.empty())
+                for (int i = 0; i < (int)std::thread::hardware_concurrency(); i++)
+                    online.push_back(i);
+
+            for (auto id : online)
+            {
+                auto dir = std::string(SYSFS_CPU "cpu") + std::to_string(id) + "/topology/";
+                auto core = _read_line(dir + "core_id");
+                auto package = _read_line(dir + "physical_package_id");
+
+                result.cpus.push_back(
+                {
+                    .id = id,
+                    .core = core.empty() ? id : std::stoi(core),
+                    .package = package.empty() ? 0 : std::stoi(package),
+                    .node = 0
+                });
+            }
+
+            // Assign processors to NUMA nodes where the system reports them
+            auto nodes = _parse_cpu_list(_read_line(SYSFS_NODE "online"));
+            for (auto node : nodes)
+                for (auto id : _parse_cpu_list(_read_line(std::string(SYSFS_NODE "node")
+                        + std::to_string(node) + "/cpulist")))
+                    for (auto& cpu : result.cpus)
+                        if (cpu.id == id)
+                            cpu.node = node;
+
+            std::set<std::pair<int, int>> cores;
+            std::set<int> packages, node_set;
+            for (auto& cpu : result.cpus)
+            {
+                cores.insert({ cpu.package, cpu.core });
+                packages.insert(cpu.package);
+                node_set.insert(cpu.node);
+            }
+
+            result.num_cores = (int)cores.size();
+            result.num_packages = (int)packages.size();
+            result.num_nodes = (int)node_set.size();
+
+            return result;
+        }();
+
+        return topology;
+    }
+
+    std::vector<int> cpu_topology::siblings(int cpu) const
+    {
+        std::vector<int> result;
+
+        for (auto& of : this->cpus)
+            if (of.id == cpu)
+                for (auto& other : this->cpus)
+                    if (other.package == of.package && other.core == of.core)
+                        result.push_back(other.id);
+
+        return result;
+    }
+
+    std::vector<int> cpu_topology::node_cpus(int node) const
+    {
+        std::vector<int> result;
+
+        for (auto& cpu : this->cpus)
+            if (cpu.node == node)
+                result.push_back(cpu.id);
+
+        return result;
+    }
+
+    std::string cpu_topology::describe() const
+    {
+        return std::to_string(this->num_packages) + " package(s), "
+            + std::to_string(this->num_nodes) + " NUMA node(s), "
+            + std::to_string(this->num_cores) + " core(s), "
+            + std::to_string(this->cpus.size()) + " logical processor(s)";
+    }
+
+    std::string describe_cpus(const std::vector<int>& cpus)
+    {
+        std::string result;
+
+        for (size_t i = 0; i < cpus.size(); i++)
+        {
+            // Collapse consecutive runs into ranges
+            auto j = i;
+            while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1)
+                j++;
+
+            if (!result.empty())
+                result += ",";
+            result += std::to_string(cpus[i]);
+            if (j > i)
+                result += "-" + std::to_string(cpus[j]);
+
+            i = j;
+        }
+
+        return result.empty() ? "any" : result;
+    }
+
+    bool pin_current_thread(const std::vector<int>& cpus)
+    {
+        if (cpus.empty())
+            return false;
+
+#ifdef _WIN32
+        DWORD_PTR mask = 0;
+        for (auto cpu : cpus)
+            if (cpu < (int)sizeof(mask) * 8)
+                mask |= (DWORD_PTR)1 << cpu;
+
+        return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (auto cpu : cpus)
+            CPU_SET(cpu, &set);
+
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        return false;
+#endif
+    }
+
+    std::vector<std::vector<int>> worker_placement::assign(const cpu_topology& topology, int num_workers) const
+    {
+        std::vector<std::vector<int>> result(num_workers);
+        if (this->mode == placement_mode::none)
+            return result;
+
+        // Exclude reserved processors (and optionally their SMT siblings)
+        std::set<int> excluded(this->reserved_cpus.begin(), this->reserved_cpus.end());
+        if (this->avoid_reserved_siblings)
+            for (auto cpu : this->reserved_cpus)
+                for (auto sibling : topology.siblings(cpu))
+                    excluded.insert(sibling);
+
+        std::vector<cpu_info> available;
+        for (auto& cpu : topology.cpus)
+            if (!excluded.count(cpu.id))
+                available.push_back(cpu);
+        if (available.empty())
+            return result;
+
+        if (this->mode == placement_mode::core)
+        {
+            // Fill distinct physical cores before doubling up on siblings
+            std::stable_sort(available.begin(), available.end(), [&](auto& a, auto& b)
+            {
+                auto rank = [&](const cpu_info& cpu)
+                {
+                    auto s = topology.siblings(cpu.id);
+                    return std::find(s.begin(), s.end(), cpu.id) - s.begin();
+                };
+                return rank(a) < rank(b);
+            });
+
+            for (int i = 0; i < num_workers; i++)
+                result[i] = { available[i % available.size()].id };
+        } else
+        {
+            std::set<int> node_ids;
+            for (auto& cpu : available)
+                node_ids.insert(cpu.node);
+
+            std::vector<std::vector<int>> nodes;
+            for (auto node : node_ids)
+            {
+                std::vector<int> cpus;
+                for (auto& cpu : available)
+                    if (cpu.node == node)
+                        cpus.push_back(cpu.id);
+
+                std::sort(cpus.begin(), cpus.end());
+                nodes.push_back(cpus);
+            }
+
+            // Spread workers evenly across nodes with available processors
+            for (int i = 0; i < num_workers; i++)
+                result[i] = nodes[i % nodes.size()];
+        }
+
+        return result;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace lemon
+{
+    /**
+     * @brief Location of a single logical processor within the system.
+     * @author Zach Goethel
+     */
+    struct cpu_info
+    {
+        /**
+         * @brief Index of the logical processor as used for affinity.
+         */
+        int id;
+
+        /**
+         * @brief Physical core; logical processors sharing it are SMT siblings.
+         */
+        int core;
+
+        /**
+         * @brief Physical processor package (socket).
+         */
+        int package;
+
+        /**
+         * @brief NUMA memory node nearest to the logical processor.
+         */
+        int node;
+    };
+
+    /**
+     * Describes the logical processors of the host system, grouped by physical
+     * core, package and NUMA node.  On Linux, the topology is read from sysfs;
+     * elsewhere, each logical processor is treated as its own core on a single
+     * package and node.
+     *
+     * @brief Processor topology of the host system.
+     * @author Zach Goethel
+     */
+    class cpu_topology
+    {
+        public:
+            std::vector<cpu_info> cpus;
+
+            int num_cores = 0;
+            int num_packages = 0;
+            int num_nodes = 0;
+
+            /**
+             * @brief Lazily detected topology of the host system.
+             */
+            static const cpu_topology& system();
+
+            /**
+             * @brief Finds the logical processors sharing a physical core.
+             * @param cpu Index of a logical processor.
+             * @return Indices of its SMT siblings, including itself.
+             */
+            std::vector<int> siblings(int cpu) const;
+
+            /**
+             * @brief Finds the logical processors of a NUMA node.
+             * @param node Index of the NUMA node.
+             * @return Indices of the logical processors within the node.
+             */
+            std::vector<int> node_cpus(int node) const;
+
+            /**
+             * @brief Summarizes the topology for log output.
+             */
+            std::string describe() const;
+    };
+
+    /**
+     * @brief Restricts the calling thread to the provided logical processors.
+     * @param cpus Indices of the logical processors the thread may run on.
+     * @return Whether the affinity was applied.
+     */
+    bool pin_current_thread(const std::vector<int>& cpus);
+
+    /**
+     * @brief Formats a set of logical processors as a compact list ("0-3,8").
+     */
+    std::string describe_cpus(const std::vector<int>& cpus);
+
+    /**
+     * How worker pool threads are bound to logical processors.
+     *
+     * @brief Placement strategy for the threads of a worker pool.
+     */
+    enum class placement_mode
+    {
+        /**
+         * @brief Threads are left free to migrate between processors.
+         */
+        none,
+
+        /**
+         * @brief Workers are spread evenly across NUMA nodes, and each may run
+         *      on any available processor within its node.
+         */
+        numa_node,
+
+        /**
+         * @brief Each worker is pinned to a single available processor.
+         */
+        core
+    };
+
+    /**
+     * Processors listed as reserved are kept free of pool workers so that
+     * context threads (pinned to them via `context::pin`) are not disturbed.
+     * Optionally, SMT siblings of the reserved processors are also excluded,
+     * so workers do not compete for the execution resources of their core.
+     *
+     * @brief Configuration of worker pool thread placement.
+     * @author Zach Goethel
+     */
+    struct worker_placement
+    {
+        placement_mode mode = placement_mode::none;
+
+        /**
+         * @brief Processors reserved for context threads and never given to
+         *      pool workers.
+         */
+        std::vector<int> reserved_cpus;
+
+        /**
+         * @brief Whether SMT siblings of reserved processors are also avoided.
+         */
+        bool avoid_reserved_siblings = true;
+
+        /**
+         * @brief Computes the processors each pool worker may run on.
+         * @param topology Processor topology of the system.
+         * @param num_workers Number of workers in the pool.
+         * @return One set of processors per worker; empty sets are unpinned.
+         */
+        std::vector<std::vector<int>> assign(const cpu_topology& topology, int num_workers) const;
+    };
+}
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <functional>
 #include <mutex>
+#include <utility>
 
 ////////////////////////////////////////////////////////////////////////////////
 //                          Lemon 3D Graphics Engine                          //
@@ -23,6 +25,7 @@ namespace lemon
     {
         T data;
         deque_node* next = nullptr;
+        deque_node* prev = nullptr;
     };
 
     /**
@@ -40,6 +43,21 @@ namespace lemon
     template <class T>
     class deque
     {
+        public:
+            deque() = default;
+            deque(const deque&) = delete;
+            deque& operator=(const deque&) = delete;
+
+            ~deque()
+            {
+                while (head != nullptr)
+                {
+                    auto d = head;
+                    head = head->next;
+                    delete d;
+                }
+            }
+
         protected:
             int len = 0;
 
@@ -52,25 +70,32 @@ namespace lemon
             void _add(T element)
             {
                 last->next = new deque_node<T>;
+                last->next->prev = last;
                 last = last->next;
-                last->data = element;
+                last->data = std::move(element);
 
                 this->len++;
             }
 
             void _push(T element)
             {
-                T* n = head->next;
+                deque_node<T>* n = head->next;
                 head->next = new deque_node<T>;
+                head->next->prev = head;
                 head->next->next = n;
-                head->next->data = element;
+                head->next->data = std::move(element);
+
+                if (n == nullptr)
+                    last = head->next;
+                else
+                    n->prev = head->next;
 
                 this->len++;
             }
 
             T _poll()
             {
-                T val = head->next->data;
+                T val = std::move(head->next->data);
                 auto d = head->next;
                 head->next = head->next->next;
                 delete d;
@@ -78,6 +103,21 @@ namespace lemon
                 this->len--;
                 if (head->next == nullptr)
                     last = head;
+                else
+                    head->next->prev = head;
+
+                return val;
+            }
+
+            T _poll_last()
+            {
+                T val = std::move(last->data);
+                auto d = last;
+                last = last->prev;
+                last->next = nullptr;
+                delete d;
+
+                this->len--;
 
                 return val;
             }
@@ -91,7 +131,22 @@ namespace lemon
             {
                 std::lock_guard<std::mutex> lock(this->mutex);
 
-                this->_add(element);
+                this->_add(std::move(element));
+            }
+
+            /**
+             * @brief Appends the provided elements while locking only once.
+             * @param elements Array of elements to move into the queue; any
+             *      type which converts to the element type is accepted.
+             * @param count Number of elements in the array.
+             */
+            template <class E>
+            void add_all(E* elements, size_t count)
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+
+                for (size_t i = 0; i < count; i++)
+                    this->_add(std::move(elements[i]));
             }
 
             /**
@@ -102,7 +157,26 @@ namespace lemon
             {
                 std::lock_guard<std::mutex> lock(this->mutex);
 
-                this->_push(element);
+                this->_push(std::move(element));
+            }
+
+            /**
+             * Elements are pushed in reverse while locking only once, so the
+             * first element of the array ends up on top of the stack and the
+             * elements are polled back in their array order.
+             * 
+             * @brief Pushes the provided elements onto the stack.
+             * @param elements Array of elements to move onto the stack; any
+             *      type which converts to the element type is accepted.
+             * @param count Number of elements in the array.
+             */
+            template <class E>
+            void push_all(E* elements, size_t count)
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+
+                for (size_t i = count; i-- > 0; )
+                    this->_push(std::move(elements[i]));
             }
 
             /**
@@ -116,6 +190,40 @@ namespace lemon
                 return this->_poll();
             }
 
+            /**
+             * @brief Polls the first element of the queue if there is one.
+             * @param element Reference which receives the removed element.
+             * @return Whether an element was available and removed.
+             */
+            bool try_poll(T& element)
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+
+                if (this->len == 0)
+                    return false;
+                element = this->_poll();
+                return true;
+            }
+
+            /**
+             * Removes from the opposite end to the one which is pushed and
+             * polled; a work-stealing scheduler takes the oldest tasks of a
+             * victim this way while the owner continues on its newest tasks.
+             * 
+             * @brief Polls the last element of the queue if there is one.
+             * @param element Reference which receives the removed element.
+             * @return Whether an element was available and removed.
+             */
+            bool try_poll_last(T& element)
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+
+                if (this->len == 0)
+                    return false;
+                element = this->_poll_last();
+                return true;
+            }
+
             /**
              * @brief Pops the top element off of the stack.
              * @return The removed top element of the stack.
@@ -0,0 +1,170 @@
+#include "frame_stats.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "scheduler_stats.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace lemon
+{
+    int frame_histogram::bucket(uint64_t nanos)
+    {
+        // Durations below the first full octave are counted exactly
+        if (nanos < FRAME_HISTOGRAM_SUB_BUCKETS)
+            return (int)nanos;
+
+        int octave = (int)std::bit_width(nanos) - 1;
+        int sub = (int)(nanos >> (octave - FRAME_HISTOGRAM_SUB_BITS)) & (FRAME_HISTOGRAM_SUB_BUCKETS - 1);
+
+        return (octave - FRAME_HISTOGRAM_SUB_BITS + 1) * FRAME_HISTOGRAM_SUB_BUCKETS + sub;
+    }
+
+    uint64_t frame_histogram::bucket_bound(int bucket)
+    {
+        if (bucket < FRAME_HISTOGRAM_SUB_BUCKETS)
+            return (uint64_t)bucket + 1;
+
+        int octave = bucket / FRAME_HISTOGRAM_SUB_BUCKETS + FRAME_HISTOGRAM_SUB_BITS - 1;
+        uint64_t sub = bucket % FRAME_HISTOGRAM_SUB_BUCKETS;
+
+        return (FRAME_HISTOGRAM_SUB_BUCKETS + sub + 1) << (octave - FRAME_HISTOGRAM_SUB_BITS);
+    }
+
+    uint64_t frame_histogram::percentile(double fraction)
+    {
+        if (this->total == 0)
+            return 0;
+
+        uint64_t seen = 0;
+        for (int i = 0; i < FRAME_HISTOGRAM_BUCKETS; i++)
+        {
+            seen += this->counts[i];
+            if (seen >= fraction * this->total)
+                return std::min(bucket_bound(i), this->worst);
+        }
+
+        return this->worst;
+    }
+
+    void frame_histogram::reset()
+    {
+        std::fill(std::begin(this->counts), std::end(this->counts), 0);
+        this->total = 0;
+        this->worst = 0;
+    }
+
+    frame_stats::frame_stats()
+    {
+        this->last_snapshot = scheduler_now();
+    }
+
+    frame_stats::~frame_stats()
+    {
+        if (this->file == nullptr)
+            return;
+
+        // Close the JSON array
+        if (this->json)
+            fputs(this->rows > 0 ? "\n]\n" : "]\n", this->file);
+        fclose(this->file);
+    }
+
+    frame_snapshot frame_stats::snapshot()
+    {
+        frame_snapshot result;
+
+        auto now = scheduler_now();
+        result.seconds = (now - this->last_snapshot) / 1000000000.0;
+        this->last_snapshot = now;
+
+        result.frames = this->frame_time.total;
+        if (result.seconds > 0.0)
+            result.frames_per_second = result.frames / result.seconds;
+
+        result.p50 = this->frame_time.percentile(0.5);
+        result.p90 = this->frame_time.percentile(0.9);
+        result.p99 = this->frame_time.percentile(0.99);
+        result.p999 = this->frame_time.percentile(0.999);
+        result.worst = this->frame_time.worst;
+
+        result.cpu_p50 = this->cpu_time.percentile(0.5);
+        result.cpu_p99 = this->cpu_time.percentile(0.99);
+        result.cpu_worst = this->cpu_time.worst;
+
+        result.context_p50 = this->context_time.percentile(0.5);
+        result.context_p99 = this->context_time.percentile(0.99);
+        result.context_worst = this->context_time.worst;
+
+        this->frame_time.reset();
+        this->cpu_time.reset();
+        this->context_time.reset();
+
+        if (this->file != nullptr)
+            this->_export(result);
+
+        return result;
+    }
+
+    bool frame_stats::export_to(std::string path)
+    {
+        if (this->file != nullptr)
+            fclose(this->file);
+
+        this->file = fopen(path.c_str(), "w");
+        if (this->file == nullptr)
+            return false;
+
+        this->json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+        this->rows = 0;
+
+        fputs(this->json ? "[" : "seconds,frames,fps,p50_ms,p90_ms,p99_ms,p999_ms,worst_ms,"
+            "cpu_p50_ms,cpu_p99_ms,cpu_worst_ms,context_p50_ms,context_p99_ms,context_worst_ms\n", this->file);
+
+        return true;
+    }
+
+    void frame_stats::_export(const frame_snapshot& s)
+    {
+        const char* format = this->json
+            ? "%s\n  {\"seconds\": %.3f, \"frames\": %llu, \"fps\": %.2f, "
+                "\"p50_ms\": %.3f, \"p90_ms\": %.3f, \"p99_ms\": %.3f, \"p999_ms\": %.3f, \"worst_ms\": %.3f, "
+                "\"cpu_p50_ms\": %.3f, \"cpu_p99_ms\": %.3f, \"cpu_worst_ms\": %.3f, "
+                "\"context_p50_ms\": %.3f, \"context_p99_ms\": %.3f, \"context_worst_ms\": %.3f}"
+            : "%s%.3f,%llu,%.2f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n";
+
+        fprintf(this->file, format,
+            this->json && this->rows > 0 ? "," : "",
+            s.seconds, (unsigned long long)s.frames, s.frames_per_second,
+            s.p50 / 1000000.0, s.p90 / 1000000.0, s.p99 / 1000000.0, s.p999 / 1000000.0, s.worst / 1000000.0,
+            s.cpu_p50 / 1000000.0, s.cpu_p99 / 1000000.0, s.cpu_worst / 1000000.0,
+            s.context_p50 / 1000000.0, s.context_p99 / 1000000.0, s.context_worst / 1000000.0);
+        fflush(this->file);
+
+        this->rows++;
+    }
+
+    std::string frame_snapshot::describe() const
+    {
+        char line[320];
+        snprintf(line, sizeof(line),
+            "%.1f fps; frame p50 %.2f p90 %.2f p99 %.2f p99.9 %.2f worst %.2f ms; "
+            "cpu p50 %.2f p99 %.2f worst %.2f ms; context p50 %.2f p99 %.2f worst %.2f ms",
+            this->frames_per_second,
+            this->p50 / 1000000.0, this->p90 / 1000000.0, this->p99 / 1000000.0,
+            this->p999 / 1000000.0, this->worst / 1000000.0,
+            this->cpu_p50 / 1000000.0, this->cpu_p99 / 1000000.0, this->cpu_worst / 1000000.0,
+            this->context_p50 / 1000000.0, this->context_p99 / 1000000.0, this->context_worst / 1000000.0);
+
+        return line;
+    }
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Histogram buckets per power of two, as bits; 64 gives 1.6% precision
+#define FRAME_HISTOGRAM_SUB_BITS 6
+#define FRAME_HISTOGRAM_SUB_BUCKETS (1 << FRAME_HISTOGRAM_SUB_BITS)
+// Number of buckets, covering every 64-bit nanosecond duration
+#define FRAME_HISTOGRAM_BUCKETS ((64 - FRAME_HISTOGRAM_SUB_BITS + 1) * FRAME_HISTOGRAM_SUB_BUCKETS)
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace lemon
+{
+    /**
+     * Durations are counted in log-linear buckets, as in an HDR histogram:
+     * each power of two is split into `FRAME_HISTOGRAM_SUB_BUCKETS` linear
+     * steps, so any frame time is reported to within two significant digits
+     * while the histogram stays a fixed size.  Unlike `latency_histogram`, it
+     * is owned by a single thread and uses plain counters.
+     *
+     * @brief Fixed-memory, high-precision histogram of frame durations.
+     * @author Zach Goethel
+     */
+    class frame_histogram
+    {
+        public:
+            uint32_t counts[FRAME_HISTOGRAM_BUCKETS] = { };
+
+            /**
+             * @brief Durations recorded since the last reset, and the longest.
+             */
+            uint64_t total = 0;
+            uint64_t worst = 0;
+
+            /**
+             * @brief Finds the bucket counting the provided duration.
+             */
+            static int bucket(uint64_t nanos);
+
+            /**
+             * @brief Smallest duration which no longer falls into a bucket.
+             */
+            static uint64_t bucket_bound(int bucket);
+
+            /**
+             * @brief Counts a duration in the histogram.
+             * @param nanos Duration in nanoseconds; negative values count as 0.
+             */
+            void record(long long nanos)
+            {
+                auto value = nanos < 0 ? 0 : (uint64_t)nanos;
+
+                this->counts[bucket(value)]++;
+                this->total++;
+                if (value > this->worst)
+                    this->worst = value;
+            }
+
+            /**
+             * @brief Finds the duration below which a fraction of the recorded
+             *      durations fall, to the precision of a bucket.
+             * @param fraction Fraction between 0 and 1 (0.999 for p99.9).
+             * @return Upper bound of the matching bucket, capped at the worst
+             *      recorded duration, or 0 if empty.
+             */
+            uint64_t percentile(double fraction);
+
+            /**
+             * @brief Clears all recorded durations.
+             */
+            void reset();
+    };
+
+    /**
+     * @brief Distribution of frame times over an interval, in nanoseconds.
+     * @author Zach Goethel
+     */
+    struct frame_snapshot
+    {
+        /**
+         * @brief Length of the interval in seconds.
+         */
+        double seconds = 0.0;
+
+        /**
+         * @brief Frames completed within the interval, and their rate.
+         */
+        uint64_t frames = 0;
+        double frames_per_second = 0.0;
+
+        /**
+         * @brief Percentiles and worst of the time between frames.
+         */
+        uint64_t p50 = 0, p90 = 0, p99 = 0, p999 = 0, worst = 0;
+
+        /**
+         * @brief Percentiles and worst of CPU time spent by the application
+         *      each frame, from input delivery through its frame graph.
+         */
+        uint64_t cpu_p50 = 0, cpu_p99 = 0, cpu_worst = 0;
+
+        /**
+         * @brief Percentiles and worst of time spent in the context's update,
+         *      which waits while too many frames are in flight.
+         */
+        uint64_t context_p50 = 0, context_p99 = 0, context_worst = 0;
+
+        /**
+         * @brief Formats the snapshot as a single line of log output.
+         */
+        std::string describe() const;
+    };
+
+    /**
+     * Each frame reports the time between frames and how much of it was spent
+     * in the application and in the context.  Snapshots summarize the frames
+     * since the previous snapshot and start a new interval; if an export file
+     * is open, each snapshot is also appended to it.
+     *
+     * Not thread-safe; owned by the thread which runs the frame loop.
+     *
+     * @brief Frame-time telemetry of an application's frame loop.
+     * @author Zach Goethel
+     */
+    class frame_stats
+    {
+        private:
+            frame_histogram frame_time;
+            frame_histogram cpu_time;
+            frame_histogram context_time;
+
+            long long last_snapshot;
+
+            /**
+             * @brief Open export file, or null.
+             */
+            FILE* file = nullptr;
+            bool json = false;
+            int rows = 0;
+
+            /**
+             * @brief Appends a snapshot to the export file.
+             */
+            void _export(const frame_snapshot& snapshot);
+
+        public:
+            frame_stats();
+
+            ~frame_stats();
+
+            /**
+             * @brief Reports the timing of a completed frame.
+             * @param frame Time since the previous frame, in nanoseconds.
+             * @param cpu Time spent by the application, in nanoseconds.
+             * @param context Time spent updating the context, in nanoseconds.
+             */
+            void record(long long frame, long long cpu, long long context)
+            {
+                this->frame_time.record(frame);
+                this->cpu_time.record(cpu);
+                this->context_time.record(context);
+            }
+
+            /**
+             * @brief Summarizes frames since the previous snapshot, and starts
+             *      the next interval.
+             */
+            frame_snapshot snapshot();
+
+            /**
+             * Each later snapshot is written as a row; files ending in ".json"
+             * receive a JSON array of objects, and others CSV with a header.
+             *
+             * @brief Starts exporting snapshots to a file for this run.
+             * @param path File to create or overwrite.
+             * @return Whether the file could be opened.
+             */
+            bool export_to(std::string path);
+    };
+}
@@ -0,0 +1,327 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "task.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace lemon
+{
+    template <typename T>
+    class future;
+
+    /**
+     * @brief Result of invoking a continuation with the value of a future.
+     */
+    template <typename T, typename F>
+    struct continuation_result
+    { using type = std::invoke_result_t<F&, T>; };
+
+    template <typename F>
+    struct continuation_result<void, F>
+    { using type = std::invoke_result_t<F&>; };
+
+    /**
+     * Shared between a promise and its future.  The value and error are
+     * written once by the producing thread before the ready flag is set; a
+     * continuation attached before completion is held until the value is
+     * available.
+     *
+     * @brief Shared completion state of a promise and future pair.
+     * @author Zach Goethel
+     */
+    template <typename T>
+    struct future_state
+    {
+        std::mutex mutex;
+        std::atomic<bool> ready { false };
+
+        std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> value;
+        std::exception_ptr error;
+
+        task continuation;
+    };
+
+    /**
+     * The producing side of a future.  A promise is fulfilled exactly once,
+     * either with a value or with an exception, which wakes any thread waiting
+     * on the future and schedules its continuation.
+     *
+     * Promises are move-only.  A promise destroyed before it was fulfilled,
+     * such as one captured by a task which was dropped or which threw before
+     * fulfilling it, completes its future with a `std::future_error` of
+     * `broken_promise`, so waiting threads and continuations are released.
+     *
+     * @brief Producer of a single asynchronous result.
+     * @author Zach Goethel
+     */
+    template <typename T>
+    class promise
+    {
+        private:
+            std::shared_ptr<future_state<T>> state = std::make_shared<future_state<T>>();
+
+            /**
+             * @brief Rejects further completion of a fulfilled promise.
+             */
+            void _check_pending()
+            {
+                if (!state)
+                    throw std::future_error(std::future_errc::no_state);
+                if (state->ready.load())
+                    throw std::future_error(std::future_errc::promise_already_satisfied);
+            }
+
+            /**
+             * @brief Completes a still pending future as broken.
+             */
+            void _abandon()
+            {
+                if (state && !state->ready.load())
+                    this->set_exception(std::make_exception_ptr(
+                        std::future_error(std::future_errc::broken_promise)));
+            }
+
+            void _complete()
+            {
+                task next;
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+
+                    state->ready = true;
+                    next = std::move(state->continuation);
+                }
+
+                state->ready.notify_all();
+                if (next)
+                    next();
+            }
+
+        public:
+            promise() = default;
+
+            promise(promise&& other) noexcept : state(std::move(other.state))
+            { }
+
+            promise& operator=(promise&& other) noexcept
+            {
+                if (this != &other)
+                {
+                    this->_abandon();
+                    state = std::move(other.state);
+                }
+
+                return *this;
+            }
+
+            promise(const promise&) = delete;
+            promise& operator=(const promise&) = delete;
+
+            ~promise()
+            {
+                this->_abandon();
+            }
+
+            /**
+             * @brief Retrieves the future which observes this promise.
+             * @return Future sharing state with this promise.
+             */
+            future<T> get_future()
+            {
+                return future<T>(state);
+            }
+
+            /**
+             * @brief Fulfills this promise with the provided value.
+             * @param value Result value; omitted for void promises.
+             */
+            template <typename... V>
+            void set_value(V&&... value)
+            {
+                this->_check_pending();
+
+                if constexpr (std::is_void_v<T>)
+                    state->value.emplace(true);
+                else
+                    state->value.emplace(std::forward<V>(value)...);
+
+                this->_complete();
+            }
+
+            /**
+             * @brief Fulfills this promise with an error.
+             * @param error Exception which will be rethrown to the consumer.
+             */
+            void set_exception(std::exception_ptr error)
+            {
+                this->_check_pending();
+
+                state->error = error;
+
+                this->_complete();
+            }
+
+            /**
+             * @brief Invokes the function and fulfills with its result.
+             * @param fn Function producing the value of this promise.
+             */
+            template <typename F>
+            void fulfill(F&& fn)
+            {
+                try
+                {
+                    if constexpr (std::is_void_v<T>)
+                    {
+                        fn();
+                        this->set_value();
+                    } else
+                        this->set_value(fn());
+                } catch(...)
+                {
+                    this->set_exception(std::current_exception());
+                }
+            }
+    };
+
+    /**
+     * The consuming side of an asynchronous result.  A future can be waited
+     * upon, or given a continuation which runs on a chosen worker thread or
+     * pool once the result is ready, producing a further future.  The result
+     * is moved out when consumed, so either call `get` or attach one
+     * continuation, but not both.
+     *
+     * Waiting on a future from the worker thread which must produce it will
+     * hang indefinitely; attach a continuation instead.
+     *
+     * @brief Lightweight handle to a result produced on another thread.
+     * @author Zach Goethel
+     */
+    template <typename T>
+    class future
+    {
+        friend class promise<T>;
+
+        private:
+            std::shared_ptr<future_state<T>> state;
+
+            future(std::shared_ptr<future_state<T>> state) : state(std::move(state))
+            { }
+
+        public:
+            future() = default;
+
+            /**
+             * @brief Checks whether the result has been produced.
+             * @return Whether the promise has been fulfilled.
+             */
+            bool ready() const
+            {
+                return state->ready.load();
+            }
+
+            /**
+             * @brief Blocks the calling thread until the result is produced.
+             */
+            void wait() const
+            {
+                state->ready.wait(false);
+            }
+
+            /**
+             * @brief Waits for and moves out the result, rethrowing any error.
+             * @return The value with which the promise was fulfilled.
+             */
+            T get()
+            {
+                this->wait();
+
+                if (state->error)
+                    std::rethrow_exception(state->error);
+                if constexpr (!std::is_void_v<T>)
+                    return std::move(*state->value);
+            }
+
+            /**
+             * Schedules the provided function to run on the executor once this
+             * future's result is ready.  The function receives the result as
+             * its argument (or no argument for void futures).  If this future
+             * failed, the error is passed along to the returned future and the
+             * function is not invoked.
+             *
+             * @brief Chains a function to run with this future's result.
+             * @param executor Worker thread, pool or context to run on.
+             * @param fn Function invoked with the result.
+             * @return Future of the value returned by the function.
+             */
+            template <typename E, typename F>
+            auto then(E& executor, F&& fn) -> future<typename continuation_result<T, std::decay_t<F>>::type>
+            {
+                using R = typename continuation_result<T, std::decay_t<F>>::type;
+
+                promise<R> next;
+                auto result = next.get_future();
+
+                task schedule = [state = this->state, &executor, fn = std::forward<F>(fn),
+                    next = std::move(next)]() mutable
+                {
+                    executor.execute([state = std::move(state), fn = std::move(fn),
+                        next = std::move(next)]() mutable
+                    {
+                        next.fulfill([&]() -> R
+                        {
+                            if (state->error)
+                                std::rethrow_exception(state->error);
+                            if constexpr (std::is_void_v<T>)
+                                return fn();
+                            else
+                                return fn(std::move(*state->value));
+                        });
+                    });
+                };
+
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+
+                    // Hold the continuation until the promise completes
+                    if (!state->ready)
+                    {
+                        state->continuation = std::move(schedule);
+                        return result;
+                    }
+                }
+
+                schedule();
+                return result;
+            }
+    };
+
+    /**
+     * @brief Creates a future which already holds the provided value.
+     * @param value Result value of the future.
+     * @return Future which is immediately ready.
+     */
+    template <typename T>
+    future<T> make_ready_future(T value)
+    {
+        promise<T> done;
+        done.set_value(std::move(value));
+
+        return done.get_future();
+    }
+}
\ No newline at end of file
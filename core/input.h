@@ -0,0 +1,67 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace lemon
+{
+    /**
+     * @brief Kind of window or input event.
+     */
+    enum class input_type
+    {
+        none,
+        key,
+        mouse_button,
+        cursor,
+        resize,
+        close
+    };
+
+    /**
+     * Events are captured by the windowing library on the thread which owns
+     * the window, then passed to the application thread through a lock-free
+     * ring and drained once per frame.  Codes and modifiers are those of the
+     * windowing library.
+     *
+     * @brief A single window or input event.
+     * @author Zach Goethel
+     */
+    struct input_event
+    {
+        input_type type = input_type::none;
+
+        /**
+         * @brief Key or mouse button of key and button events.
+         */
+        int code = 0;
+
+        /**
+         * @brief Press, release or repeat action of key and button events.
+         */
+        int action = 0;
+
+        /**
+         * @brief Modifier keys held during key and button events.
+         */
+        int mods = 0;
+
+        /**
+         * @brief Cursor position, or window size of resize events.
+         */
+        double x = 0.0, y = 0.0;
+
+        /**
+         * @brief Time at which the event was captured, as from
+         *      `scheduler_now`.
+         */
+        long long time = 0;
+    };
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Leading bytes of every binary trace log, followed by the format version
+#define LOG_TRACE_MAGIC "LEMONLOG"
+#define LOG_TRACE_VERSION 1
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace lemon
+{
+    /**
+     * A binary trace log starts with `LOG_TRACE_MAGIC` and a 32-bit version,
+     * followed by entries which each start with one of these tags.  Values
+     * are stored in the byte order of the host which wrote the log.
+     *
+     *  - `format`: id (u32), length (u32), then the format string's bytes.
+     *  - `source`: id (u32), length (u32), then the logger's name.
+     *  - `record`: time (i64, nanoseconds since the Unix epoch), thread id
+     *      (u32), source id (u32), level (u8), format id (u32), argument
+     *      count (u8), then each argument as a `trace_arg` tag and its value.
+     *
+     * Format strings and loggers are defined once, before the first record
+     * which refers to them, so records carry only their ids.
+     *
+     * @brief Tag identifying each entry of a binary trace log.
+     */
+    enum class trace_tag : uint8_t
+    {
+        format = 1,
+        source = 2,
+        record = 3
+    };
+
+    /**
+     * @brief Type of an argument within a trace record.  Integers and floats
+     *      are stored as eight bytes, booleans and characters as one, and
+     *      strings as a length (u32) and their bytes.
+     */
+    enum class trace_arg : uint8_t
+    {
+        int64 = 1,
+        uint64 = 2,
+        float64 = 3,
+        boolean = 4,
+        character = 5,
+        string = 6
+    };
+
+    /**
+     * @brief Appends a fixed-size value in host byte order.
+     */
+    template <typename T>
+    void _trace_put(std::string& out, T value)
+    {
+        out.append((const char*)&value, sizeof(T));
+    }
+
+    /**
+     * @brief Appends a length-prefixed string.
+     */
+    inline void _trace_put_string(std::string& out, std::string_view value)
+    {
+        _trace_put<uint32_t>(out, (uint32_t)value.size());
+        out += value;
+    }
+
+    /**
+     * @brief Appends a tagged argument of a trace record.
+     */
+    template <typename T>
+    void _trace_arg(std::string& out, const T& value)
+    {
+        if constexpr (std::is_same_v<T, bool>)
+        {
+            _trace_put(out, trace_arg::boolean);
+            _trace_put<uint8_t>(out, value ? 1 : 0);
+        } else if constexpr (std::is_same_v<T, char>)
+        {
+            _trace_put(out, trace_arg::character);
+            _trace_put(out, value);
+        } else if constexpr (std::is_enum_v<T>)
+            _trace_arg(out, (std::underlying_type_t<T>)value);
+        else if constexpr (std::is_floating_point_v<T>)
+        {
+            _trace_put(out, trace_arg::float64);
+            _trace_put<double>(out, value);
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+        {
+            _trace_put(out, trace_arg::int64);
+            _trace_put<int64_t>(out, value);
+        } else if constexpr (std::is_integral_v<T>)
+        {
+            _trace_put(out, trace_arg::uint64);
+            _trace_put<uint64_t>(out, value);
+        } else
+        {
+            _trace_put(out, trace_arg::string);
+            _trace_put_string(out, std::string_view(value));
+        }
+    }
+
+    /**
+     * @brief Reads entries of a binary trace log from a buffer.
+     */
+    struct trace_reader
+    {
+        const char* data;
+        size_t size;
+        size_t offset = 0;
+
+        /**
+         * @brief Set once a read runs past the end of the buffer.
+         */
+        bool truncated = false;
+
+        /**
+         * @brief Reads a fixed-size value, or zero if truncated.
+         */
+        template <typename T>
+        T get()
+        {
+            T value { };
+            if (this->offset + sizeof(T) > this->size)
+            {
+                this->truncated = true;
+                return value;
+            }
+
+            memcpy(&value, this->data + this->offset, sizeof(T));
+            this->offset += sizeof(T);
+            return value;
+        }
+
+        /**
+         * @brief Reads a length-prefixed string, or an empty string if
+         *      truncated.
+         */
+        std::string_view get_string()
+        {
+            auto length = this->get<uint32_t>();
+            if (this->truncated || this->offset + length > this->size)
+            {
+                this->truncated = true;
+                return { };
+            }
+
+            std::string_view value(this->data + this->offset, length);
+            this->offset += length;
+            return value;
+        }
+
+        bool done()
+        {
+            return this->truncated || this->offset >= this->size;
+        }
+    };
+}
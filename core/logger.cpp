@@ -1,8 +1,17 @@
 #include "logger.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
 #include <ctime>
-#include <math.h>
+#include <map>
 #include <mutex>
+#include <string_view>
+#include <thread>
+
+#include "mpsc_queue.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 //                          Lemon 3D Graphics Engine                          //
@@ -14,6 +23,13 @@
 //  ------------------------------------------------------------------------  //
 ////////////////////////////////////////////////////////////////////////////////
 
+// Most records the sink formats before writing them out together
+#define LOGGER_SINK_BATCH 256
+// Format strings interned in a trace log; later ones are stored inline
+#define LOGGER_TRACE_FORMATS 4096
+// Size of the trace file's write buffer
+#define LOGGER_TRACE_BUFFER (1 << 20)
+
 // The default coloration and pattern of a log message
 #define LOGGER_PATTERN std::string("\033[0;37m%d{yyyy-MM-dd} %t{hh:mm:ss}\033\
 [1;36m[%5p\033[1;36m][\033[1;37m%-15c\033[1;36m]\033[0;37m: %m%n\033[0m")
@@ -26,40 +42,62 @@ namespace lemon
 		return mutex;
 	}
 
-	logger::logger(std::string pattern, std::string name)
+	/**
+	 * @brief State of the background thread which writes queued log records.
+	 */
+	struct log_sink
 	{
-		this->pattern = pattern;
-		this->name = name;
-	}
+		mpsc_queue<log_record, LOGGER_QUEUE_CAPACITY> records;
+		log_overflow overflow = log_overflow::count;
 
-	// Overloaded constructor with default pattern
-	logger::logger(std::string name) : logger::logger(LOGGER_PATTERN, name)
-	{ }
+		/**
+		 * @brief Records discarded under the drop and count policies.
+		 */
+		std::atomic<uint64_t> dropped { 0 };
+
+		/**
+		 * @brief Records queued and written so far, compared when flushing.
+		 */
+		std::atomic<uint64_t> queued { 0 };
+		std::atomic<uint64_t> written { 0 };
+
+		/**
+		 * @brief Set while the sink thread is (about to be) blocked.
+		 */
+		std::atomic<bool> sleeping { false };
+		bool stopping = false;
+
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable drained;
+
+		std::thread thread;
+
+		~log_sink();
+	};
+
+	// Sink receiving records once asynchronous output is started
+	std::atomic<log_sink*> _async_sink { nullptr };
 
 	/**
-	 * @brief Convenience method for printing justified text.
+	 * Walks the pattern once, so that formatting a message only replays the
+	 * resulting tokens.  Runs of literal text are merged into single tokens.
+	 * 
+	 * @brief Compiles a log pattern into the steps which format a message.
+	 * @param pattern Pattern of the form described by `LOGGER_PATTERN`.
 	 */
-	void print(std::string message, int width, bool left_justify)
+	std::vector<log_token> _compile(const std::string& pattern)
 	{
-		// If left justified, print the message first
-		if (!left_justify)
-			std::cout << message.substr(0, width == 0 ? message.length() : width);
-		// Print spacing for justification offset
-		for (int i = 0; i < width - (int)message.length(); i++)
-			std::cout << " ";
-		// If left justified, print the message last
-		if (left_justify)
-			std::cout << message.substr(0, width == 0 ? message.length() : width);
-	}
+		std::vector<log_token> program;
 
-	void logger::log(std::string level, std::string level_color, std::string message)
-	{
-		// Lock mutex in order to synchronize logging
-		std::lock_guard<std::mutex> lock(_log_mutex());
+		// Appends a literal character, extending any preceding literal
+		auto literal = [&](char c)
+		{
+			if (program.empty() || program.back().type != log_token_type::text)
+				program.emplace_back();
+			program.back().text += c;
+		};
 
-		// Convert to C strings and capture time
-		auto pattern_c = pattern.c_str();
-		auto now_c = time(nullptr);
 		// Track flags for parsing log pattern
 		bool within_brackets = false;
 		bool within_token = false;
@@ -67,102 +105,83 @@ namespace lemon
 		bool is_left_justify = false;
 		// Track powers of ten for number printing
 		int num_digits_accum = 0;
-
-		// Localize the date/time
-		auto date_time = localtime(&now_c);
-
-		// Store the last command character and numerical digit
-		char prev_command = ' ';
+		// Store the last date/time character to count repeated digits
 		char prev_digit = ' ';
-		// Track number of digits for date format
-		int num_digit_count = 0;
 
-		// Iterate through the pattern string
-		//TODO ADD ADDITIONAL DOCUMENTATION
-		for (unsigned int i = 0; i < pattern.length(); i++)
+		for (char c : pattern)
 		{
-			char c = pattern_c[i];
-
 			if (within_brackets)
 			{
-				if (c == prev_digit)
-					num_digit_count++;
-				else
-				{
-					num_digit_count = 0;
-
-					now_c = time(nullptr);
-					date_time = localtime(&now_c);
-
-					date_time->tm_year += 1900;
-					date_time->tm_mon += 1;
-				}
-
+				// Locate the field's digits within "yyyyMMddhhmmss"
+				int offset = -1, digits = 2;
 				switch (c)
 				{
-				case 'y':
-					std::cout << date_time->tm_year / (int)pow(10, 3 - num_digit_count);
-					date_time->tm_year %= (int)pow(10, 3 - num_digit_count);
-					break;
-				case 'M':
-					std::cout << date_time->tm_mon / (int)pow(10, 1 - num_digit_count);
-					date_time->tm_mon %= (int)pow(10, 1 - num_digit_count);
-					break;
-				case 'd':
-					std::cout << date_time->tm_mday / (int)pow(10, 1 - num_digit_count);
-					date_time->tm_mday %= (int)pow(10, 1 - num_digit_count);
-					break;
+				case 'y': offset = 0; digits = 4; break;
+				case 'M': offset = 4; break;
+				case 'd': offset = 6; break;
+				case 'h': offset = 8; break;
+				case 'm': offset = 10; break;
+				case 's': offset = 12; break;
 
-				case 'h':
-					std::cout << date_time->tm_hour / (int)pow(10, 1 - num_digit_count);
-					date_time->tm_hour %= (int)pow(10, 1 - num_digit_count);
-					break;
-				case 'm':
-					std::cout << date_time->tm_min / (int)pow(10, 1 - num_digit_count);
-					date_time->tm_min %= (int)pow(10, 1 - num_digit_count);
-					break;
-				case 's':
-					std::cout << date_time->tm_sec / (int)pow(10, 1 - num_digit_count);
-					date_time->tm_sec %= (int)pow(10, 1 - num_digit_count);
-					break;
-
-				case '}' :
+				case '}':
 					within_brackets = false;
 					within_token = false;
 					break;
 
 				default:
-					std::cout << c;
+					literal(c);
+				}
+
+				if (offset >= 0)
+				{
+					// Each repeat of a field character prints its next digit
+					if (!program.empty() && c == prev_digit && program.back().type == log_token_type::clock
+						&& program.back().offset == offset)
+						program.back().width = std::min(program.back().width + 1, digits);
+					else
+					{
+						log_token token;
+						token.type = log_token_type::clock;
+						token.offset = offset;
+						token.width = 1;
+						program.push_back(token);
+					}
 				}
 
 				prev_digit = c;
 			} else if (within_token)
 			{
+				log_token token;
+				token.width = num_digits_accum;
+				token.left_justify = is_left_justify;
+
 				switch (c)
 				{
 				case '{':
 					within_brackets = true;
 					break;
-			
+
 				case 'd':
 				case 't':
 					break;
 
 				case 'm':
-					print(message, num_digits_accum, is_left_justify);
+					token.type = log_token_type::message;
+					program.push_back(token);
 					within_token = false;
 					break;
 				case 'c':
-					print(name, num_digits_accum, is_left_justify);
+					token.type = log_token_type::name;
+					program.push_back(token);
 					within_token = false;
 					break;
 				case 'n':
-					std::cout << std::endl;
+					literal('\n');
 					within_token = false;
 					break;
 				case 'p':
-					std::cout << level_color;
-					print(level, num_digits_accum, is_left_justify);
+					token.type = log_token_type::level;
+					program.push_back(token);
 					within_token = false;
 					break;
 
@@ -187,8 +206,6 @@ namespace lemon
 				default:
 					within_token = false;
 				}
-
-				prev_command = c;
 			} else
 			{
 				switch (c)
@@ -200,29 +217,625 @@ namespace lemon
 					break;
 
 				default:
-					std::cout << c;
+					literal(c);
 				}
 			}
 		}
+
+		return program;
+	}
+
+	logger::logger(std::string pattern, std::string name)
+	{
+		static std::atomic<uint32_t> next_id { 1 };
+
+		auto program = _compile(pattern);
+		this->source = std::make_shared<const log_source>(
+			log_source { name, pattern, std::move(program), next_id.fetch_add(1) });
+	}
+
+	// Overloaded constructor with default pattern
+	logger::logger(std::string name) : logger::logger(LOGGER_PATTERN, name)
+	{ }
+
+	/**
+	 * @brief Digits of the local date and time of the most recently
+	 * 		formatted second, as "yyyyMMddhhmmss".
+	 */
+	struct _clock_cache
+	{
+		time_t second = -1;
+		char digits[14];
+	};
+
+	/**
+	 * @brief Finds the date and time digits of the provided second, only
+	 * 		localizing the time when the second changes.
+	 */
+	const char* _clock_digits(time_t time)
+	{
+		thread_local _clock_cache cache;
+		if (cache.second == time)
+			return cache.digits;
+
+		// The result of localtime is shared by all threads
+		static std::mutex localtime_mutex;
+		std::tm local;
+		{
+			std::lock_guard<std::mutex> lock(localtime_mutex);
+			local = *localtime(&time);
+		}
+
+		// Writes a zero-padded field from its last digit backwards
+		auto put = [&](int offset, int digits, int value)
+		{
+			for (int i = offset + digits - 1; i >= offset; i--, value /= 10)
+				cache.digits[i] = (char)('0' + value % 10);
+		};
+
+		put(0, 4, local.tm_year + 1900);
+		put(4, 2, local.tm_mon + 1);
+		put(6, 2, local.tm_mday);
+		put(8, 2, local.tm_hour);
+		put(10, 2, local.tm_min);
+		put(12, 2, local.tm_sec);
+
+		cache.second = time;
+		return cache.digits;
+	}
+
+	/**
+	 * @brief Convenience method for printing justified text.
+	 */
+	void print(std::string& out, std::string_view message, int width, bool left_justify)
+	{
+		auto length = width == 0 ? message.length() : std::min(message.length(), (size_t)width);
+
+		// If left justified, print the message first
+		if (!left_justify)
+			out.append(message.data(), length);
+		// Print spacing for justification offset
+		if (width > (int)message.length())
+			out.append(width - message.length(), ' ');
+		// If left justified, print the message last
+		if (left_justify)
+			out.append(message.data(), length);
+	}
+
+	/**
+	 * @brief Formats a record by replaying its logger's compiled pattern.
+	 * @param record The record to format.
+	 * @param out String to which the formatted text is appended.
+	 */
+	void _format(const log_record& record, std::string& out)
+	{
+		// Date and time digits, looked up on the first clock token
+		const char* clock = nullptr;
+
+		for (auto& token : record.source->program)
+			switch (token.type)
+			{
+			case log_token_type::text:
+				out += token.text;
+				break;
+
+			case log_token_type::message:
+				print(out, record.message, token.width, token.left_justify);
+				break;
+			case log_token_type::name:
+				print(out, record.source->name, token.width, token.left_justify);
+				break;
+			case log_token_type::level:
+				out += record.level_color;
+				print(out, record.level, token.width, token.left_justify);
+				break;
+
+			case log_token_type::clock:
+				if (clock == nullptr)
+					clock = _clock_digits(record.time);
+				out.append(clock + token.offset, token.width);
+				break;
+			}
+	}
+
+	/**
+	 * @brief Writes formatted text to the console in a single flushed write.
+	 */
+	void _write(const std::string& text)
+	{
+		std::lock_guard<std::mutex> lock(_log_mutex());
+
+		std::cout.write(text.data(), text.size());
+		std::cout.flush();
+	}
+
+	/**
+	 * @brief Wakes the sink thread if it is (about to be) blocked.
+	 */
+	void _wake_sink(log_sink& sink)
+	{
+		// Order the record's publication before reading the sleeping flag
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (sink.sleeping.load(std::memory_order_relaxed) && sink.sleeping.exchange(false))
+		{
+			{
+				std::lock_guard<std::mutex> lock(sink.mutex);
+			}
+
+			sink.wake.notify_one();
+		}
+	}
+
+	/**
+	 * @brief Loop of the sink thread, which formats and writes queued records
+	 * 		in batches until the sink is destroyed.
+	 */
+	void _run_sink(log_sink& sink)
+	{
+		auto source = std::make_shared<const log_source>(
+			log_source { "Logger", LOGGER_PATTERN, _compile(LOGGER_PATTERN) });
+
+		log_record record;
+		std::string batch;
+
+		while (true)
+		{
+			batch.clear();
+			int count = 0;
+
+			while (count < LOGGER_SINK_BATCH && sink.records.try_poll(record))
+			{
+				_format(record, batch);
+				record = log_record();
+				count++;
+			}
+
+			// Report records discarded while the queue was full
+			auto dropped = sink.overflow == log_overflow::count ? sink.dropped.exchange(0) : 0;
+			if (dropped > 0)
+				_format(
+				{
+					source, "WARN", "\033[1;33m", time(nullptr),
+					std::to_string(dropped) + " log messages were dropped; the log queue was full"
+				}, batch);
+
+			if (!batch.empty())
+				_write(batch);
+
+			if (count > 0)
+			{
+				sink.written.fetch_add(count);
+				{
+					std::lock_guard<std::mutex> lock(sink.mutex);
+				}
+				sink.drained.notify_all();
+
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(sink.mutex);
+			if (sink.stopping)
+				break;
+
+			sink.sleeping.store(true, std::memory_order_relaxed);
+			// Order the flag before checking the queue a final time
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (!sink.records.empty())
+			{
+				sink.sleeping.store(false);
+				continue;
+			}
+
+			sink.wake.wait(lock, [&]()
+			{
+				return !sink.sleeping.load() || sink.stopping;
+			});
+		}
+	}
+
+	log_sink::~log_sink()
+	{
+		_async_sink.store(nullptr);
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->stopping = true;
+			this->sleeping.store(false);
+		}
+		this->wake.notify_one();
+
+		// The sink drains every queued record before stopping
+		if (this->thread.joinable())
+			this->thread.join();
+	}
+
+	void logger::start_async(log_overflow overflow)
+	{
+		static log_sink sink;
+
+		std::lock_guard<std::mutex> lock(sink.mutex);
+		sink.overflow = overflow;
+		if (!sink.thread.joinable())
+			sink.thread = std::thread(_run_sink, std::ref(sink));
+
+		_async_sink.store(&sink);
+	}
+
+	/**
+	 * @brief Open binary trace log, and the ids already defined within it.
+	 */
+	struct log_trace_file
+	{
+		std::mutex mutex;
+		FILE* file = nullptr;
+
+		/**
+		 * @brief Ids of interned format strings; id zero is reserved for
+		 * 		records which carry their format inline.
+		 */
+		std::map<std::string, uint32_t, std::less<>> formats;
+
+		/**
+		 * @brief Whether each logger, by id, has been defined.
+		 */
+		std::vector<bool> sources;
+
+		/**
+		 * @brief Scratch buffer for assembling entries.
+		 */
+		std::string entry;
+
+		~log_trace_file()
+		{
+			if (this->file != nullptr)
+				fclose(this->file);
+		}
+	};
+
+	log_trace_file& _trace_file()
+	{
+		static log_trace_file trace;
+		return trace;
+	}
+
+	std::string& logger::_trace_buffer()
+	{
+		thread_local std::string buffer;
+		return buffer;
+	}
+
+	void logger::_trace(log_level level, std::string_view format, int count, const std::string& args)
+	{
+		auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count();
+
+		// Number threads compactly in the order they first trace
+		static std::atomic<uint32_t> next_thread { 1 };
+		thread_local uint32_t thread = next_thread.fetch_add(1);
+
+		auto& trace = _trace_file();
+		std::lock_guard<std::mutex> lock(trace.mutex);
+		if (trace.file == nullptr)
+			return;
+
+		auto& entry = trace.entry;
+		entry.clear();
+
+		// Define the logger before its first record
+		auto source = this->source->id;
+		if (source >= trace.sources.size())
+			trace.sources.resize(source + 1);
+		if (!trace.sources[source])
+		{
+			_trace_put(entry, trace_tag::source);
+			_trace_put<uint32_t>(entry, source);
+			_trace_put_string(entry, this->source->name);
+			trace.sources[source] = true;
+		}
+
+		// Intern the format string, unless the table is full
+		uint32_t format_id = 0;
+		auto found = trace.formats.find(format);
+		if (found != trace.formats.end())
+			format_id = found->second;
+		else if (trace.formats.size() < LOGGER_TRACE_FORMATS)
+		{
+			format_id = (uint32_t)trace.formats.size() + 1;
+			trace.formats.emplace(format, format_id);
+
+			_trace_put(entry, trace_tag::format);
+			_trace_put<uint32_t>(entry, format_id);
+			_trace_put_string(entry, format);
+		}
+
+		_trace_put(entry, trace_tag::record);
+		_trace_put<int64_t>(entry, time);
+		_trace_put<uint32_t>(entry, thread);
+		_trace_put<uint32_t>(entry, source);
+		_trace_put<uint8_t>(entry, (uint8_t)level);
+		_trace_put<uint32_t>(entry, format_id);
+		_trace_put<uint8_t>(entry, (uint8_t)(count + (format_id == 0 ? 1 : 0)));
+		// Records without an interned format carry it as the first argument
+		if (format_id == 0)
+			_trace_arg(entry, format);
+		entry += args;
+
+		fwrite(entry.data(), 1, entry.size(), trace.file);
 	}
 
-	void logger::debug(std::string message)
+	bool logger::start_trace(std::string path)
 	{
-		this->log("DEBUG", "\033[1;34m", message);
+		auto& trace = _trace_file();
+		std::lock_guard<std::mutex> lock(trace.mutex);
+
+		if (trace.file != nullptr)
+			fclose(trace.file);
+		trace.formats.clear();
+		trace.sources.clear();
+
+		trace.file = fopen(path.c_str(), "wb");
+		if (trace.file == nullptr)
+		{
+			tracing.store(false);
+			return false;
+		}
+		setvbuf(trace.file, nullptr, _IOFBF, LOGGER_TRACE_BUFFER);
+
+		std::string header = LOG_TRACE_MAGIC;
+		_trace_put<uint32_t>(header, LOG_TRACE_VERSION);
+		fwrite(header.data(), 1, header.size(), trace.file);
+
+		tracing.store(true);
+		return true;
 	}
 
-	void logger::info(std::string message)
+	void logger::stop_trace()
 	{
-		this->log("INFO", "\033[1;32m", message);
+		tracing.store(false);
+
+		auto& trace = _trace_file();
+		std::lock_guard<std::mutex> lock(trace.mutex);
+
+		if (trace.file != nullptr)
+			fclose(trace.file);
+		trace.file = nullptr;
 	}
 
-	void logger::warn(std::string message)
+	void logger::flush()
 	{
-		this->log("WARN", "\033[1;33m", message);
+		if (tracing.load())
+		{
+			auto& trace = _trace_file();
+			std::lock_guard<std::mutex> lock(trace.mutex);
+
+			if (trace.file != nullptr)
+				fflush(trace.file);
+		}
+
+		auto sink = _async_sink.load();
+		if (sink == nullptr)
+			return;
+
+		auto target = sink->queued.load();
+		_wake_sink(*sink);
+
+		std::unique_lock<std::mutex> lock(sink->mutex);
+		sink->drained.wait(lock, [&]()
+		{
+			return sink->written.load() >= target;
+		});
 	}
 
-	void logger::error(std::string message)
+	/**
+	 * @brief Counters of one message of a rate-limited logger.
+	 */
+	struct log_limit_slot
 	{
-		this->log("ERROR", "\033[1;31m", message);
+		/**
+		 * @brief Id of the message, or zero while the slot is free.
+		 */
+		std::atomic<uint64_t> id { 0 };
+
+		std::atomic<uint32_t> count { 0 };
+		std::atomic<uint32_t> suppressed { 0 };
+
+		/**
+		 * @brief Text identifying the message in summaries; written once,
+		 * 		before the id is published.
+		 */
+		std::string label;
+	};
+
+	/**
+	 * @brief Rate limits of a logger, and its counts in the current window.
+	 */
+	class log_limiter
+	{
+	public:
+		int per_logger = 0;
+		int per_message = 0;
+		long long window = 0;
+
+		/**
+		 * @brief Time at which the current window ends.
+		 */
+		std::atomic<long long> window_end { 0 };
+
+		std::atomic<uint32_t> count { 0 };
+		std::atomic<uint32_t> suppressed { 0 };
+
+		/**
+		 * @brief Open-addressed table of messages, by id.  Slots are never
+		 * 		freed; once full, new messages count only against the logger.
+		 */
+		log_limit_slot slots[LOGGER_LIMIT_SLOTS];
+
+		/**
+		 * @brief Guards claiming slots and summarizing windows, neither of
+		 * 		which happens for suppressed messages.
+		 */
+		std::mutex mutex;
+	};
+
+	void logger::limit(int per_logger, int per_message, long long window)
+	{
+		auto limiter = std::make_shared<log_limiter>();
+		limiter->per_logger = per_logger;
+		limiter->per_message = per_message;
+		limiter->window = window;
+
+		this->limiter = limiter;
+	}
+
+	void logger::_roll(long long now)
+	{
+		auto& limiter = *this->limiter;
+
+		// Only one thread summarizes; others carry on with the old window
+		std::unique_lock<std::mutex> lock(limiter.mutex, std::try_to_lock);
+		if (!lock.owns_lock() || now < limiter.window_end.load())
+			return;
+		limiter.window_end.store(now + limiter.window);
+
+		for (auto& slot : limiter.slots)
+		{
+			if (slot.id.load(std::memory_order_acquire) == 0)
+				continue;
+
+			slot.count.store(0, std::memory_order_relaxed);
+			auto suppressed = slot.suppressed.exchange(0, std::memory_order_relaxed);
+			if (suppressed > 0)
+				this->_emit(log_level::warn, "Message repeated " + std::to_string(suppressed)
+					+ " more times: " + slot.label);
+		}
+
+		limiter.count.store(0, std::memory_order_relaxed);
+		auto suppressed = limiter.suppressed.exchange(0, std::memory_order_relaxed);
+		if (suppressed > 0)
+			this->_emit(log_level::warn, "Suppressed " + std::to_string(suppressed)
+				+ " messages over the limit of " + std::to_string(limiter.per_logger) + " per window");
+	}
+
+	bool logger::_limit(uint64_t id, std::string_view label)
+	{
+		auto& limiter = *this->limiter;
+
+		auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+		if (now >= limiter.window_end.load(std::memory_order_relaxed))
+			this->_roll(now);
+
+		// Once the logger's budget is spent, suppress without claiming a slot
+		if (limiter.per_logger > 0
+			&& limiter.count.load(std::memory_order_relaxed) >= (uint32_t)limiter.per_logger)
+		{
+			limiter.suppressed.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		if (limiter.per_message > 0)
+		{
+			// Zero marks free slots
+			id = id == 0 ? 1 : id;
+			log_limit_slot* found = nullptr;
+
+			for (int i = 0; i < LOGGER_LIMIT_SLOTS && found == nullptr; i++)
+			{
+				auto& slot = limiter.slots[(id + i) % LOGGER_LIMIT_SLOTS];
+				auto key = slot.id.load(std::memory_order_acquire);
+
+				if (key == 0)
+				{
+					// Claim a free slot for a message not yet seen
+					std::lock_guard<std::mutex> lock(limiter.mutex);
+					key = slot.id.load(std::memory_order_relaxed);
+					if (key == 0)
+					{
+						slot.label = label.substr(0, 80);
+						slot.id.store(id, std::memory_order_release);
+						key = id;
+					}
+				}
+
+				if (key == id)
+					found = &slot;
+			}
+
+			if (found != nullptr
+				&& found->count.fetch_add(1, std::memory_order_relaxed) >= (uint32_t)limiter.per_message)
+			{
+				found->suppressed.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+		}
+
+		if (limiter.per_logger > 0
+			&& limiter.count.fetch_add(1, std::memory_order_relaxed) >= (uint32_t)limiter.per_logger)
+		{
+			limiter.suppressed.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		return true;
+	}
+
+	void logger::log(log_level level, std::string message)
+	{
+		if (level == log_level::off || !enabled(level) || !this->_admit(message))
+			return;
+
+		this->_emit(level, std::move(message));
+	}
+
+	void logger::log(log_level level, uint64_t id, std::string_view message)
+	{
+		if (level == log_level::off || !enabled(level))
+			return;
+		if (this->limiter != nullptr && !this->_limit(id, message))
+			return;
+
+		this->_emit(level, std::string(message));
+	}
+
+	void logger::_emit(log_level level, std::string message)
+	{
+		if (tracing.load(std::memory_order_relaxed))
+		{
+			auto& buffer = _trace_buffer();
+			buffer.clear();
+			_trace_arg(buffer, message);
+
+			this->_trace(level, "{}", 1, buffer);
+			return;
+		}
+
+		// Names and console coloration of each level
+		static const char* names[] = { "DEBUG", "INFO", "WARN", "ERROR" };
+		static const char* colors[] = { "\033[1;34m", "\033[1;32m", "\033[1;33m", "\033[1;31m" };
+
+		log_record record { this->source, names[(int)level], colors[(int)level], time(nullptr), std::move(message) };
+
+		auto sink = _async_sink.load(std::memory_order_acquire);
+		if (sink == nullptr)
+		{
+			// Reuse each thread's buffer to avoid allocating per message
+			thread_local std::string text;
+			text.clear();
+			_format(record, text);
+			_write(text);
+
+			return;
+		}
+
+		if (sink->overflow == log_overflow::block)
+			sink->records.add(std::move(record));
+		else if (!sink->records.try_add(std::move(record)))
+		{
+			sink->dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		sink->queued.fetch_add(1);
+		_wake_sink(*sink);
 	}
 }
@@ -1,8 +1,37 @@
 #pragma once
 
+#include <atomic>
+#include <charconv>
+#include <ctime>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "log_trace.h"
+
+// Number of records which may await the asynchronous log sink
+#ifndef LOGGER_QUEUE_CAPACITY
+	#define LOGGER_QUEUE_CAPACITY 4096
+#endif
+
+// Severity levels, in increasing order, for use in preprocessor conditions
+#define LOGGER_LEVEL_DEBUG 0
+#define LOGGER_LEVEL_INFO 1
+#define LOGGER_LEVEL_WARN 2
+#define LOGGER_LEVEL_ERROR 3
+#define LOGGER_LEVEL_OFF 4
+
+// Least severe level compiled into the build; calls below it compile away
+#ifndef LOGGER_MIN_LEVEL
+	#define LOGGER_MIN_LEVEL LOGGER_LEVEL_DEBUG
+#endif
+
+// Distinct messages tracked by each rate-limited logger
+#define LOGGER_LIMIT_SLOTS 64
 
 ////////////////////////////////////////////////////////////////////////////////
 //                          Lemon 3D Graphics Engine                          //
@@ -18,6 +47,172 @@ namespace lemon
 {
 	std::mutex& _log_mutex();
 
+	/**
+	 * @brief Severity of a log message, in increasing order.
+	 */
+	enum class log_level
+	{
+		debug = LOGGER_LEVEL_DEBUG,
+		info = LOGGER_LEVEL_INFO,
+		warn = LOGGER_LEVEL_WARN,
+		error = LOGGER_LEVEL_ERROR,
+		off = LOGGER_LEVEL_OFF
+	};
+
+	/**
+	 * @brief Appends a single formatting argument to a message.
+	 */
+	template <typename T>
+	void _log_append(std::string& out, const T& value)
+	{
+		if constexpr (std::is_same_v<T, bool>)
+			out += value ? "true" : "false";
+		else if constexpr (std::is_same_v<T, char>)
+			out += value;
+		else if constexpr (std::is_enum_v<T>)
+			_log_append(out, (std::underlying_type_t<T>)value);
+		else if constexpr (std::is_floating_point_v<T>)
+		{
+			// Six decimals, matching std::to_string; fits any double
+			char digits[512];
+			auto result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::fixed, 6);
+			out.append(digits, result.ptr);
+		} else if constexpr (std::is_integral_v<T>)
+		{
+			char digits[24];
+			auto result = std::to_chars(digits, digits + sizeof(digits), value);
+			out.append(digits, result.ptr);
+		} else
+			out += std::string_view(value);
+	}
+
+	/**
+	 * @brief Appends a format string, replacing each "{}" with the next
+	 * 		argument.  Placeholders without an argument are kept literally.
+	 */
+	inline void _log_format(std::string& out, std::string_view format)
+	{
+		out += format;
+	}
+
+	template <typename T, typename... Args>
+	void _log_format(std::string& out, std::string_view format, const T& value, const Args&... args)
+	{
+		auto hole = format.find("{}");
+		if (hole == std::string_view::npos)
+		{
+			out += format;
+			return;
+		}
+
+		out += format.substr(0, hole);
+		_log_append(out, value);
+		_log_format(out, format.substr(hole + 2), args...);
+	}
+
+	/**
+	 * @brief Behavior of asynchronous logging when the record queue is full.
+	 */
+	enum class log_overflow
+	{
+		/**
+		 * @brief The logging thread waits until the sink frees space.
+		 */
+		block,
+
+		/**
+		 * @brief The record is discarded silently.
+		 */
+		drop,
+
+		/**
+		 * @brief The record is discarded, and the number of discarded records
+		 * 		is reported by the sink once it catches up.
+		 */
+		count
+	};
+
+	/**
+	 * @brief Kind of output produced by one step of a compiled log pattern.
+	 */
+	enum class log_token_type
+	{
+		text,
+		message,
+		name,
+		level,
+		clock
+	};
+
+	/**
+	 * @brief One step of a log pattern, compiled once per logger.
+	 */
+	struct log_token
+	{
+		log_token_type type = log_token_type::text;
+
+		/**
+		 * @brief Literal text of text tokens.
+		 */
+		std::string text;
+
+		/**
+		 * @brief Justified width of message, name and level tokens (zero for
+		 * 		none), or the digits printed by clock tokens.
+		 */
+		int width = 0;
+		bool left_justify = false;
+
+		/**
+		 * @brief First digit printed by clock tokens within the cached
+		 * 		"yyyyMMddhhmmss" digits of the current second.
+		 */
+		int offset = 0;
+	};
+
+	/**
+	 * @brief Immutable identity of a logger, shared with its queued records
+	 * 		so that they remain valid after the logger is destroyed.
+	 */
+	struct log_source
+	{
+		std::string name;
+		std::string pattern;
+
+		/**
+		 * @brief The pattern, compiled into the steps which format a message.
+		 */
+		std::vector<log_token> program;
+
+		/**
+		 * @brief Process-wide unique id, identifying the logger in trace logs.
+		 */
+		uint32_t id = 0;
+	};
+
+	/**
+	 * @brief A single message awaiting formatting by the log sink.
+	 */
+	struct log_record
+	{
+		std::shared_ptr<const log_source> source;
+
+		/**
+		 * @brief Severity name and its console coloration; string literals.
+		 */
+		const char* level = nullptr;
+		const char* level_color = nullptr;
+
+		/**
+		 * @brief Time at which the message was logged.
+		 */
+		time_t time = 0;
+
+		std::string message;
+	};
+
+	class log_limiter;
+
 	/**
 	 * A rudimentary logger which provides various levels of severity for logged
 	 * messages. This class provides a partial and very rudimentary implementation
@@ -26,6 +221,26 @@ namespace lemon
 	 * Consult the default logger pattern in the implementation file for an example
 	 * log message pattern.
 	 * 
+	 * By default, messages are formatted and written by the logging thread.  Once
+	 * `start_async` is called, logging only moves a compact record into a lock-
+	 * free queue, and a background thread formats and writes records in batches,
+	 * so that threads such as the render thread never wait on terminal output.
+	 * 
+	 * Messages are filtered twice.  Levels below `LOGGER_MIN_LEVEL` compile away
+	 * entirely, and levels below the runtime threshold (`set_level`) are
+	 * discarded after a single relaxed load.  Messages are written as format
+	 * strings with "{}" placeholders, which are only formatted once the level
+	 * is known to be enabled.
+	 * 
+	 * Loggers of noisy subsystems may be rate-limited with `limit`; messages
+	 * beyond the limit are counted without formatting or locking, and later
+	 * summarized as "repeated N times".
+	 * 
+	 * For long-running tests, `start_trace` switches every logger to a compact
+	 * binary trace file instead.  Records hold only ids of the logger and the
+	 * format string along with the raw arguments; they are turned back into
+	 * text or JSON offline by the trace decoder tool.
+	 * 
 	 * @brief A simple logger for logging info and error messages.
 	 * @author Zach Goethel
 	 */
@@ -33,14 +248,95 @@ namespace lemon
 	{
 	private:
 		/**
-		 * @brief The name of this logger to help identify it in log messages.
+		 * @brief The name of this logger and the pattern for formatting its
+		 * 		messages.
 		 */
-		std::string name;
+		std::shared_ptr<const log_source> source;
 
 		/**
-		 * @brief Pattern for formatting messages logged by this instance.
+		 * @brief Least severe level which is currently logged.
 		 */
-		std::string pattern;
+		static inline std::atomic<int> threshold { LOGGER_LEVEL_DEBUG };
+
+		/**
+		 * @brief Whether messages are written to the binary trace file.
+		 */
+		static inline std::atomic<bool> tracing { false };
+
+		/**
+		 * @brief Counters limiting the rate of messages, or null if unlimited.
+		 */
+		std::shared_ptr<log_limiter> limiter;
+
+		/**
+		 * @brief Counts a message against the rate limits.
+		 * @param id Id of the message, counted against the per-message limit.
+		 * @param label Text identifying the message in summaries.
+		 * @return Whether the message is within the limits.
+		 */
+		bool _limit(uint64_t id, std::string_view label);
+
+		/**
+		 * @brief Counts a message against the rate limits, if any, identifying
+		 * 		it by its format string.
+		 */
+		bool _admit(std::string_view format)
+		{
+			return this->limiter == nullptr
+				|| this->_limit(std::hash<std::string_view>()(format), format);
+		}
+
+		/**
+		 * @brief Summarizes suppressed messages once a rate-limit window ends,
+		 * 		and starts the next window.
+		 */
+		void _roll(long long now);
+
+		/**
+		 * @brief Writes an admitted message to the trace file or the terminal.
+		 */
+		void _emit(log_level level, std::string message);
+
+		/**
+		 * @brief Scratch buffer of the calling thread for encoding arguments.
+		 */
+		static std::string& _trace_buffer();
+
+		/**
+		 * @brief Writes a binary trace record of already-encoded arguments.
+		 * @param level The severity level of this log message.
+		 * @param format Format string, interned in the trace log.
+		 * @param count Number of encoded arguments.
+		 * @param args Arguments, each encoded by `_trace_arg`.
+		 */
+		void _trace(log_level level, std::string_view format, int count, const std::string& args);
+
+		/**
+		 * @brief Formats and logs a message once its level is known to be
+		 * 		enabled.
+		 */
+		template <log_level level, typename... Args>
+		void _log(std::string_view format, const Args&... args)
+		{
+			if constexpr ((int)level >= LOGGER_MIN_LEVEL)
+				if (enabled(level) && this->_admit(format))
+				{
+					// Trace records keep the raw arguments, unformatted
+					if (tracing.load(std::memory_order_relaxed))
+					{
+						auto& buffer = _trace_buffer();
+						buffer.clear();
+						(_trace_arg(buffer, args), ...);
+
+						this->_trace(level, format, (int)sizeof...(Args), buffer);
+						return;
+					}
+
+					std::string message;
+					_log_format(message, format, args...);
+					this->_emit(level, std::move(message));
+				}
+		}
 
 	public:
 		/**
@@ -59,35 +355,133 @@ namespace lemon
 		logger(std::string name);
 
 		/**
-		 * @brief Logs a colored message to the terminal with severity.
+		 * @brief Checks whether messages of a level are logged, both by the
+		 * 		build and at runtime.
+		 */
+		static bool enabled(log_level level)
+		{
+			return (int)level >= LOGGER_MIN_LEVEL
+				&& (int)level >= threshold.load(std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief Sets the least severe level which is logged, for all loggers.
+		 * 		Levels below `LOGGER_MIN_LEVEL` remain disabled regardless.
+		 */
+		static void set_level(log_level level)
+		{
+			threshold.store((int)level, std::memory_order_relaxed);
+		}
+
+		/**
+		 * @brief Logs a colored message to the terminal with severity, if the
+		 * 		level is enabled.
 		 * @param level The severity level of this log message.
-		 * @param level_color Formatting characters for the console output.
 		 * @param message Log message contents.
 		 */
-		void log(std::string level, std::string level_color, std::string message);
+		void log(log_level level, std::string message);
+
+		/**
+		 * @brief Logs a message, if the level is enabled, rate-limiting it
+		 * 		under an explicit id rather than by its text.  The message is
+		 * 		only copied once admitted by the limits.
+		 * @param level The severity level of this log message.
+		 * @param id Id of the message, such as a driver's message id.
+		 * @param message Log message contents.
+		 */
+		void log(log_level level, uint64_t id, std::string_view message);
+
+		/**
+		 * Messages beyond either limit within a window are counted rather
+		 * than logged.  Summaries of suppressed messages are written by the
+		 * first message after the window ends.  Messages are identified by
+		 * their format string, or by an explicit id.  Set limits before the
+		 * logger is shared between threads.
+		 * 
+		 * @brief Rate-limits messages of this logger.
+		 * @param per_logger Messages per window across the logger, or zero for
+		 * 		no limit.
+		 * @param per_message Messages per window with the same id, or zero for
+		 * 		no limit.
+		 * @param window Length of each window in nanoseconds.
+		 */
+		void limit(int per_logger, int per_message, long long window = 1000000000);
 
 		/**
 		 * @brief Logs a debug level message.
-		 * @param message Message contents.
+		 * @param format Message contents, with a "{}" for each argument.
+		 * @param args Values substituted into the message.
 		 */
-		void debug(std::string message);
+		template <typename... Args>
+		void debug(std::string_view format, const Args&... args)
+		{
+			this->_log<log_level::debug>(format, args...);
+		}
 
 		/**
 		 * @brief Logs an info level message.
-		 * @param message Message contents.
+		 * @param format Message contents, with a "{}" for each argument.
+		 * @param args Values substituted into the message.
 		 */
-		void info(std::string message);
+		template <typename... Args>
+		void info(std::string_view format, const Args&... args)
+		{
+			this->_log<log_level::info>(format, args...);
+		}
 
 		/**
 		 * @brief Logs a warning level message.
-		 * @param message Message contents.
+		 * @param format Message contents, with a "{}" for each argument.
+		 * @param args Values substituted into the message.
 		 */
-		void warn(std::string message);
+		template <typename... Args>
+		void warn(std::string_view format, const Args&... args)
+		{
+			this->_log<log_level::warn>(format, args...);
+		}
 
 		/**
 		 * @brief Logs an error level message.
-		 * @param message Message contents.
+		 * @param format Message contents, with a "{}" for each argument.
+		 * @param args Values substituted into the message.
+		 */
+		template <typename... Args>
+		void error(std::string_view format, const Args&... args)
+		{
+			this->_log<log_level::error>(format, args...);
+		}
+
+		/**
+		 * Starts the background sink thread; later messages are queued rather
+		 * than written by the logging thread.  Call `flush` before shutdown to
+		 * ensure queued messages are written; remaining messages are also
+		 * written when the sink is destroyed at exit.
+		 * 
+		 * @brief Switches all loggers to asynchronous output.
+		 * @param overflow Behavior when the record queue is full.
+		 */
+		static void start_async(log_overflow overflow = log_overflow::count);
+
+		/**
+		 * @brief Blocks until every message queued so far has been written,
+		 * 		including to the trace file.
+		 */
+		static void flush();
+
+		/**
+		 * Replaces text output of all loggers with binary records written to
+		 * the provided file; see `trace_tag` for the layout.  Records are
+		 * buffered, and written out by `flush` and `stop_trace`.
+		 * 
+		 * @brief Starts writing a binary trace log.
+		 * @param path File to create or overwrite.
+		 * @return Whether the file could be opened.
+		 */
+		static bool start_trace(std::string path);
+
+		/**
+		 * @brief Closes the trace file and returns to text output.
 		 */
-		void error(std::string message);
+		static void stop_trace();
 	};
 }
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace lemon
+{
+    /**
+     * A single element of the ring buffer.  The sequence number tracks which
+     * lap of the ring the slot belongs to and whether it is filled.
+     *
+     * @brief Multiple-producer single-consumer queue slot.
+     * @author Zach Goethel
+     */
+    template <class T>
+    struct mpsc_slot
+    {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    /**
+     * A bounded lock-free queue which any number of threads may add to, but
+     * only one thread may poll from.  Elements are stored in a ring of slots
+     * which is allocated once upon construction and recycled thereafter, so
+     * adding an element never takes a lock or allocates a node.
+     *
+     * Producers claim a slot by advancing the shared enqueue position, then
+     * publish the element by advancing the slot's sequence number.  Because a
+     * producer may be preempted between claiming and publishing, the consumer
+     * may briefly observe an empty front slot while later slots are already
+     * filled.  If the ring is full, `add` yields until the consumer frees a
+     * slot, while `try_add` fails so that the producer may put the element
+     * elsewhere; producers which may run on the consumer's own thread must
+     * not wait.
+     *
+     * @brief Bounded lock-free multiple-producer single-consumer queue.
+     * @author Zach Goethel
+     */
+    template <class T, size_t capacity>
+    class mpsc_queue
+    {
+        static_assert(capacity >= 2 && (capacity & (capacity - 1)) == 0,
+            "Queue capacity must be a power of two");
+
+        protected:
+            mpsc_slot<T>* slots = new mpsc_slot<T>[capacity];
+
+            alignas(64) std::atomic<size_t> enqueue_pos { 0 };
+            alignas(64) size_t dequeue_pos = 0;
+
+        public:
+            mpsc_queue()
+            {
+                for (size_t i = 0; i < capacity; i++)
+                    slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+
+            mpsc_queue(const mpsc_queue&) = delete;
+            mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+            ~mpsc_queue()
+            {
+                delete[] slots;
+            }
+
+            /**
+             * @brief Appends the provided element to the queue.  Thread-safe.
+             * @param element Element to append to the queue.
+             */
+            void add(T element)
+            {
+                auto pos = enqueue_pos.load(std::memory_order_relaxed);
+                mpsc_slot<T>* slot;
+
+                while (true)
+                {
+                    slot = &slots[pos & (capacity - 1)];
+                    auto seq = slot->sequence.load(std::memory_order_acquire);
+                    auto diff = (intptr_t)seq - (intptr_t)pos;
+
+                    if (diff == 0)
+                    {
+                        // Slot is free on this lap; attempt to claim it
+                        if (enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                std::memory_order_relaxed))
+                            break;
+                    } else if (diff < 0)
+                    {
+                        // Ring is full; wait for the consumer to catch up
+                        std::this_thread::yield();
+                        pos = enqueue_pos.load(std::memory_order_relaxed);
+                    } else
+                        // Another producer claimed this slot first
+                        pos = enqueue_pos.load(std::memory_order_relaxed);
+                }
+
+                slot->data = std::move(element);
+                slot->sequence.store(pos + 1, std::memory_order_release);
+            }
+
+            /**
+             * @brief Appends the provided element unless the queue is full.
+             *      Thread-safe and never waits.
+             * @param element Element to append to the queue; only moved from
+             *      if it was added.
+             * @return Whether the element was added.
+             */
+            bool try_add(T&& element)
+            {
+                auto pos = enqueue_pos.load(std::memory_order_relaxed);
+                mpsc_slot<T>* slot;
+
+                while (true)
+                {
+                    slot = &slots[pos & (capacity - 1)];
+                    auto seq = slot->sequence.load(std::memory_order_acquire);
+                    auto diff = (intptr_t)seq - (intptr_t)pos;
+
+                    if (diff == 0)
+                    {
+                        if (enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                std::memory_order_relaxed))
+                            break;
+                    } else if (diff < 0)
+                        return false;
+                    else
+                        pos = enqueue_pos.load(std::memory_order_relaxed);
+                }
+
+                slot->data = std::move(element);
+                slot->sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+
+            /**
+             * Claims a run of consecutive slots with a single atomic operation
+             * and then publishes each element, so the elements stay adjacent
+             * in the queue even while other threads are adding.  The count
+             * must not exceed the capacity of the ring.  Elements may be of any
+             * type which converts to the queue's element type.
+             *
+             * @brief Appends the provided elements to the queue.  Thread-safe.
+             * @param elements Array of elements to move into the queue.
+             * @param count Number of elements in the array.
+             */
+            template <class E>
+            void add_all(E* elements, size_t count)
+            {
+                if (count == 0)
+                    return;
+
+                auto pos = enqueue_pos.load(std::memory_order_relaxed);
+                while (true)
+                {
+                    // Slots are freed in order, so the run is free if its last
+                    // slot is free on this lap
+                    auto seq = slots[(pos + count - 1) & (capacity - 1)].sequence.load(std::memory_order_acquire);
+                    auto diff = (intptr_t)seq - (intptr_t)(pos + count - 1);
+
+                    if (diff == 0)
+                    {
+                        if (enqueue_pos.compare_exchange_weak(pos, pos + count,
+                                std::memory_order_relaxed))
+                            break;
+                    } else if (diff < 0)
+                    {
+                        std::this_thread::yield();
+                        pos = enqueue_pos.load(std::memory_order_relaxed);
+                    } else
+                        pos = enqueue_pos.load(std::memory_order_relaxed);
+                }
+
+                for (size_t i = 0; i < count; i++)
+                {
+                    auto slot = &slots[(pos + i) & (capacity - 1)];
+                    slot->data = std::move(elements[i]);
+                    slot->sequence.store(pos + i + 1, std::memory_order_release);
+                }
+            }
+
+            /**
+             * Like `add_all`, but fails without waiting if the ring does not
+             * currently have room for every element.
+             *
+             * @brief Appends all of the provided elements unless the queue is
+             *      too full to hold them.  Thread-safe and never waits.
+             * @param elements Array of elements to move into the queue; only
+             *      moved from if they were added.
+             * @param count Number of elements in the array.
+             * @return Whether the elements were added.
+             */
+            template <class E>
+            bool try_add_all(E* elements, size_t count)
+            {
+                if (count == 0)
+                    return true;
+                if (count > capacity)
+                    return false;
+
+                auto pos = enqueue_pos.load(std::memory_order_relaxed);
+                while (true)
+                {
+                    auto seq = slots[(pos + count - 1) & (capacity - 1)].sequence.load(std::memory_order_acquire);
+                    auto diff = (intptr_t)seq - (intptr_t)(pos + count - 1);
+
+                    if (diff == 0)
+                    {
+                        if (enqueue_pos.compare_exchange_weak(pos, pos + count,
+                                std::memory_order_relaxed))
+                            break;
+                    } else if (diff < 0)
+                        return false;
+                    else
+                        pos = enqueue_pos.load(std::memory_order_relaxed);
+                }
+
+                for (size_t i = 0; i < count; i++)
+                {
+                    auto slot = &slots[(pos + i) & (capacity - 1)];
+                    slot->data = std::move(elements[i]);
+                    slot->sequence.store(pos + i + 1, std::memory_order_release);
+                }
+
+                return true;
+            }
+
+            /**
+             * Only the single consumer thread may call this method.  An element
+             * which has been claimed by a producer but not yet published is
+             * not considered available.
+             *
+             * @brief Checks whether the first element of the queue is published.
+             * @return Whether a call to poll would return immediately.
+             */
+            bool empty()
+            {
+                auto slot = &slots[dequeue_pos & (capacity - 1)];
+                return slot->sequence.load(std::memory_order_acquire) != dequeue_pos + 1;
+            }
+
+            /**
+             * Only the single consumer thread may call this method.
+             *
+             * @brief Polls the first element of the queue if it is published.
+             * @param element Reference which receives the removed element.
+             * @return Whether an element was available and removed.
+             */
+            bool try_poll(T& element)
+            {
+                auto slot = &slots[dequeue_pos & (capacity - 1)];
+                auto seq = slot->sequence.load(std::memory_order_acquire);
+
+                if (seq != dequeue_pos + 1)
+                    return false;
+
+                element = std::move(slot->data);
+                // Release any state held by the moved-from element
+                slot->data = T();
+                slot->sequence.store(dequeue_pos + capacity, std::memory_order_release);
+                dequeue_pos++;
+
+                return true;
+            }
+
+            /**
+             * Only the single consumer thread may call this method.
+             *
+             * @brief Polls and removes the first element, waiting until the
+             *      producer which claimed the front slot has published it.
+             * @return The removed front element of the queue.
+             */
+            T poll()
+            {
+                T element;
+                while (!this->try_poll(element))
+                    std::this_thread::yield();
+
+                return element;
+            }
+    };
+}
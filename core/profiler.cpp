@@ -0,0 +1,212 @@
+#include "profiler.h"
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace lemon
+{
+    /**
+     * @brief Events recorded by a single thread.  Only the owning thread
+     *      appends; writers read events below the published size.
+     */
+    struct profile_buffer
+    {
+        /**
+         * @brief Allocated by the first recorded event, so that threads which
+         *      are only named cost no memory.
+         */
+        std::unique_ptr<profile_event[]> events;
+
+        /**
+         * @brief Number of events recorded, published after each event.
+         */
+        std::atomic<uint32_t> size { 0 };
+
+        /**
+         * @brief Profile to which the recorded events belong.
+         */
+        std::atomic<uint32_t> generation { 0 };
+
+        /**
+         * @brief Events discarded since the buffer filled up.
+         */
+        std::atomic<uint32_t> dropped { 0 };
+
+        /**
+         * @brief Track id and name of the owning thread.
+         */
+        int id;
+        std::string name;
+    };
+
+    /**
+     * @brief Buffers of every thread which has recorded events or been named.
+     */
+    struct profile_registry
+    {
+        /**
+         * @brief Guards registration, naming, starting and writing; never
+         *      taken while recording an event.
+         */
+        std::mutex mutex;
+        std::vector<std::unique_ptr<profile_buffer>> buffers;
+
+        /**
+         * @brief Current profile; events of older profiles are discarded.
+         */
+        std::atomic<uint32_t> generation { 1 };
+        long long started = 0;
+    };
+
+    profile_registry& _profile_registry()
+    {
+        static profile_registry registry;
+        return registry;
+    }
+
+    /**
+     * @brief Finds the calling thread's buffer, creating it on first use.
+     */
+    profile_buffer& _profile_buffer()
+    {
+        thread_local profile_buffer* buffer = nullptr;
+        if (buffer != nullptr)
+            return *buffer;
+
+        auto& registry = _profile_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        registry.buffers.push_back(std::make_unique<profile_buffer>());
+        buffer = registry.buffers.back().get();
+        buffer->id = (int)registry.buffers.size();
+        buffer->name = "Thread " + std::to_string(buffer->id);
+
+        return *buffer;
+    }
+
+    void profiler::start()
+    {
+        auto& registry = _profile_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        // Each thread discards its old events on its next record
+        registry.generation.fetch_add(1);
+        registry.started = scheduler_now();
+        active.store(true);
+    }
+
+    void profiler::name_thread(std::string name)
+    {
+        auto& buffer = _profile_buffer();
+
+        std::lock_guard<std::mutex> lock(_profile_registry().mutex);
+        buffer.name = std::move(name);
+    }
+
+    void profiler::record(const char* name, long long start, long long end)
+    {
+        auto& buffer = _profile_buffer();
+
+        // Start over if the events belong to a previous profile
+        auto generation = _profile_registry().generation.load(std::memory_order_acquire);
+        if (buffer.generation.load(std::memory_order_relaxed) != generation)
+        {
+            buffer.size.store(0, std::memory_order_relaxed);
+            buffer.dropped.store(0, std::memory_order_relaxed);
+            buffer.generation.store(generation, std::memory_order_release);
+        }
+
+        if (buffer.events == nullptr)
+            buffer.events.reset(new profile_event[PROFILER_THREAD_EVENTS]);
+
+        auto size = buffer.size.load(std::memory_order_relaxed);
+        if (size >= PROFILER_THREAD_EVENTS)
+        {
+            buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        buffer.events[size] = { name, start, end };
+        buffer.size.store(size + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Writes a string as a quoted JSON string.
+     */
+    void _write_json_string(FILE* file, const char* value)
+    {
+        fputc('"', file);
+        for (auto c = value; *c; c++)
+            if (*c == '"' || *c == '\\')
+                fprintf(file, "\\%c", *c);
+            else if ((unsigned char)*c < 0x20)
+                fprintf(file, "\\u%04x", *c);
+            else
+                fputc(*c, file);
+        fputc('"', file);
+    }
+
+    bool profiler::stop(std::string path)
+    {
+        active.store(false);
+
+        auto& registry = _profile_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        FILE* file = fopen(path.c_str(), "w");
+        if (file == nullptr)
+            return false;
+
+        auto generation = registry.generation.load();
+        bool first = true;
+
+        fputs("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [", file);
+        for (auto& buffer : registry.buffers)
+        {
+            // Name the thread's track
+            fprintf(file, "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": ",
+                first ? "" : ",", buffer->id);
+            _write_json_string(file, buffer->name.c_str());
+            fputs("}}", file);
+            first = false;
+
+            if (buffer->generation.load(std::memory_order_acquire) != generation)
+                continue;
+
+            // Timestamps are in microseconds since the profile started
+            auto size = buffer->size.load(std::memory_order_acquire);
+            for (uint32_t i = 0; i < size; i++)
+            {
+                auto& event = buffer->events[i];
+                // Skip scopes which began before the profile started
+                if (event.start < registry.started)
+                    continue;
+
+                fputs(",\n{\"name\": ", file);
+                _write_json_string(file, event.name);
+                fprintf(file, ", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+                    buffer->id, (event.start - registry.started) / 1000.0, (event.end - event.start) / 1000.0);
+            }
+
+            auto dropped = buffer->dropped.load(std::memory_order_relaxed);
+            if (dropped > 0)
+                fprintf(file, ",\n{\"name\": \"%u events dropped\", \"ph\": \"i\", \"s\": \"t\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f}",
+                    dropped, buffer->id, (scheduler_now() - registry.started) / 1000.0);
+        }
+        fputs("\n]}\n", file);
+
+        return fclose(file) == 0;
+    }
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#include "scheduler_stats.h"
+
+// Events buffered per thread between starting and stopping the profiler
+#ifndef PROFILER_THREAD_EVENTS
+    #define PROFILER_THREAD_EVENTS (1 << 16)
+#endif
+
+// Declares a uniquely named scope object on the current line
+#define LEMON_PROFILE_CONCAT_(a, b) a##b
+#define LEMON_PROFILE_CONCAT(a, b) LEMON_PROFILE_CONCAT_(a, b)
+/**
+ * Records the enclosing scope as a named event while the profiler runs.  The
+ * name must outlive the profile, as string literals do.
+ */
+#define LEMON_PROFILE_SCOPE(name) ::lemon::profile_scope LEMON_PROFILE_CONCAT(_profile_scope_, __LINE__) { name }
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace lemon
+{
+    /**
+     * @brief A completed scope, as recorded by the thread which ran it.
+     */
+    struct profile_event
+    {
+        const char* name;
+        long long start;
+        long long end;
+    };
+
+    /**
+     * Each thread appends completed scopes to its own fixed-size buffer, so
+     * recording takes no locks; a buffer which fills up drops further events
+     * until the next profile.  Stopping the profiler writes every thread's
+     * events as Chrome `trace_event` JSON, which loads in `chrome://tracing`
+     * and in the Perfetto UI, with one track per named thread.
+     *
+     * While stopped, a profiled scope costs a single relaxed atomic load.
+     *
+     * @brief Process-wide recorder of profiled scopes across all threads.
+     * @author Zach Goethel
+     */
+    class profiler
+    {
+        public:
+            static inline std::atomic<bool> active { false };
+
+            /**
+             * @brief Checks whether scopes are currently being recorded.
+             */
+            static bool running()
+            {
+                return active.load(std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief Discards any previous events and starts recording.
+             */
+            static void start();
+
+            /**
+             * @brief Stops recording and writes the recorded events.
+             * @param path File to create or overwrite with trace JSON.
+             * @return Whether the file could be written.
+             */
+            static bool stop(std::string path);
+
+            /**
+             * @brief Names the calling thread's track in written profiles.
+             */
+            static void name_thread(std::string name);
+
+            /**
+             * @brief Records a completed scope on the calling thread.
+             * @param name Name of the scope; must outlive the profile.
+             * @param start Time at which the scope began, as from
+             *      `scheduler_now`.
+             * @param end Time at which the scope ended.
+             */
+            static void record(const char* name, long long start, long long end);
+    };
+
+    /**
+     * Usually declared through `LEMON_PROFILE_SCOPE`.  A scope may also be
+     * ended and begun again explicitly, which keeps a coroutine's scope from
+     * spanning a suspension during which it may move to another thread.
+     *
+     * @brief Records its own lifetime as a profile event.
+     * @author Zach Goethel
+     */
+    class profile_scope
+    {
+        private:
+            const char* name;
+
+            /**
+             * @brief Time at which the scope began, or zero if not recording.
+             */
+            long long started = 0;
+
+        public:
+            profile_scope(const char* name) : name(name)
+            {
+                this->begin();
+            }
+
+            profile_scope(const profile_scope&) = delete;
+            profile_scope& operator=(const profile_scope&) = delete;
+
+            ~profile_scope()
+            {
+                this->end();
+            }
+
+            /**
+             * @brief Starts timing the scope, if the profiler is running.
+             */
+            void begin()
+            {
+                this->started = profiler::running() ? scheduler_now() : 0;
+            }
+
+            /**
+             * @brief Records the scope, if it is being timed.
+             */
+            void end()
+            {
+                if (this->started != 0)
+                    profiler::record(this->name, this->started, scheduler_now());
+                this->started = 0;
+            }
+    };
+}
@@ -32,4 +32,16 @@ namespace lemon
         } else
             throw std::runtime_error("Could not open requested file ('" + path + "')");
     }
+
+    generator<std::string> read_lines(std::string path)
+    {
+        std::string line;
+        std::ifstream input(path);
+
+        if (!input.is_open())
+            throw std::runtime_error("Could not open requested file ('" + path + "')");
+
+        while (getline(input, line))
+            co_yield line;
+    }
 }
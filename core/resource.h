@@ -49,4 +49,11 @@ namespace lemon
     };
 
     std::string read_file(std::string path, bool aggregate = true, std::function<void(std::string)> per_line = [](auto s) { });
+
+    /**
+     * @brief Lazily reads the provided file one line per iteration.
+     * @param path Path of the file to read.
+     * @return Generator yielding each line of the file.
+     */
+    generator<std::string> read_lines(std::string path);
 }
@@ -0,0 +1,151 @@
+#include "scheduler_stats.h"
+
+#include <bit>
+#include <cstdio>
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace lemon
+{
+    int latency_histogram::bucket(uint64_t nanos)
+    {
+        // Durations below the first full octave are counted exactly
+        if (nanos < LATENCY_SUB_BUCKETS)
+            return (int)nanos;
+
+        int octave = (int)std::bit_width(nanos) - 1;
+        int sub = (int)(nanos >> (octave - 2)) & (LATENCY_SUB_BUCKETS - 1);
+
+        return (octave - 1) * LATENCY_SUB_BUCKETS + sub;
+    }
+
+    uint64_t latency_histogram::bucket_bound(int bucket)
+    {
+        if (bucket < LATENCY_SUB_BUCKETS)
+            return (uint64_t)bucket + 1;
+
+        int octave = bucket / LATENCY_SUB_BUCKETS + 1;
+        uint64_t sub = bucket % LATENCY_SUB_BUCKETS;
+
+        return (LATENCY_SUB_BUCKETS + sub + 1) << (octave - 2);
+    }
+
+    uint64_t latency_histogram::total()
+    {
+        uint64_t result = 0;
+        for (auto& count : this->counts)
+            result += count.load(std::memory_order_relaxed);
+
+        return result;
+    }
+
+    uint64_t latency_histogram::percentile(double fraction)
+    {
+        auto total = this->total();
+        if (total == 0)
+            return 0;
+
+        uint64_t seen = 0;
+        for (int i = 0; i < LATENCY_BUCKETS; i++)
+        {
+            seen += this->counts[i].load(std::memory_order_relaxed);
+            if (seen >= fraction * total)
+                return bucket_bound(i);
+        }
+
+        return bucket_bound(LATENCY_BUCKETS - 1);
+    }
+
+    /**
+     * @brief Finds the median and 99th percentile of the counts added since
+     *      the previous copy, and updates the copy to the current counts.
+     */
+    void _percentiles(latency_histogram& histogram, uint64_t* last, uint64_t& p50, uint64_t& p99)
+    {
+        uint64_t window[LATENCY_BUCKETS];
+        uint64_t total = 0;
+
+        for (int i = 0; i < LATENCY_BUCKETS; i++)
+        {
+            auto count = histogram.counts[i].load(std::memory_order_relaxed);
+            window[i] = count - last[i];
+            last[i] = count;
+            total += window[i];
+        }
+
+        p50 = p99 = 0;
+        if (total == 0)
+            return;
+
+        uint64_t seen = 0;
+        for (int i = 0; i < LATENCY_BUCKETS; i++)
+        {
+            seen += window[i];
+            if (p50 == 0 && seen * 2 >= total)
+                p50 = latency_histogram::bucket_bound(i);
+            if (seen * 100 >= total * 99)
+            {
+                p99 = latency_histogram::bucket_bound(i);
+                break;
+            }
+        }
+    }
+
+    void scheduler_stats::enqueued(size_t count)
+    {
+        auto now = this->depth.fetch_add((long long)count, std::memory_order_relaxed) + (long long)count;
+
+        // Raise the high-water mark if this addition exceeds it
+        auto max = this->max_depth.load(std::memory_order_relaxed);
+        while (now > max && !this->max_depth.compare_exchange_weak(max, now, std::memory_order_relaxed))
+            ;
+    }
+
+    scheduler_snapshot scheduler_stats::snapshot(std::string name)
+    {
+        std::lock_guard<std::mutex> lock(this->snapshot_mutex);
+        scheduler_snapshot result;
+        result.name = name;
+
+        auto now = scheduler_now();
+        result.seconds = (now - this->last_snapshot) / 1000000000.0;
+        this->last_snapshot = now;
+
+        auto completed = this->completed.load(std::memory_order_relaxed);
+        result.tasks = completed - this->last_completed;
+        this->last_completed = completed;
+        if (result.seconds > 0.0)
+            result.tasks_per_second = result.tasks / result.seconds;
+
+        _percentiles(this->wait_time, this->last_wait, result.wait_p50, result.wait_p99);
+        _percentiles(this->run_time, this->last_run, result.run_p50, result.run_p99);
+
+        // Start the next interval's high-water mark from the current depth
+        result.depth = this->depth.load(std::memory_order_relaxed);
+        result.max_depth = this->max_depth.exchange(result.depth, std::memory_order_relaxed);
+
+        return result;
+    }
+
+    std::string scheduler_snapshot::describe() const
+    {
+        char line[256];
+        snprintf(line, sizeof(line),
+            "%s: %llu tasks (%.1f/s), wait p50 %.1f us p99 %.1f us, run p50 %.1f us p99 %.1f us, depth %lld (max %lld)",
+            this->name.c_str(),
+            (unsigned long long)this->tasks, this->tasks_per_second,
+            this->wait_p50 / 1000.0, this->wait_p99 / 1000.0,
+            this->run_p50 / 1000.0, this->run_p99 / 1000.0,
+            this->depth, this->max_depth);
+
+        return line;
+    }
+}
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "task.h"
+
+// Histogram buckets per power of two; each octave is split into four
+#define LATENCY_SUB_BUCKETS 4
+// Number of histogram buckets, covering every 64-bit nanosecond duration
+#define LATENCY_BUCKETS (64 * LATENCY_SUB_BUCKETS)
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace lemon
+{
+    /**
+     * @brief Reads the monotonic clock used by scheduler telemetry.
+     * @return Current time in nanoseconds since an arbitrary epoch.
+     */
+    inline long long scheduler_now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * A task as stored in a scheduler queue, stamped with the time at which
+     * it was queued so that its wait before execution can be measured.
+     * Tasks convert implicitly, so queues of timed tasks accept plain tasks.
+     *
+     * @brief Queued task with its enqueue timestamp.
+     * @author Zach Goethel
+     */
+    struct timed_task
+    {
+        task job;
+
+        /**
+         * @brief Time at which the task was queued, in nanoseconds.
+         */
+        long long enqueued = 0;
+
+        timed_task()
+        { }
+
+        timed_task(task job) : job(std::move(job)), enqueued(scheduler_now())
+        { }
+    };
+
+    /**
+     * Durations are counted in logarithmic buckets, four per power of two, so
+     * any recorded value is reported to within 25% while the histogram stays
+     * a fixed size.  Recording is a single relaxed atomic increment.
+     *
+     * @brief Lock-free histogram of nanosecond durations.
+     * @author Zach Goethel
+     */
+    class latency_histogram
+    {
+        public:
+            std::atomic<uint64_t> counts[LATENCY_BUCKETS] = { };
+
+            /**
+             * @brief Finds the bucket counting the provided duration.
+             */
+            static int bucket(uint64_t nanos);
+
+            /**
+             * @brief Smallest duration which no longer falls into a bucket.
+             */
+            static uint64_t bucket_bound(int bucket);
+
+            /**
+             * @brief Number of durations recorded in the histogram.
+             */
+            uint64_t total();
+
+            /**
+             * @brief Finds the duration below which a fraction of the recorded
+             *      durations fall, to the precision of a bucket.
+             * @param fraction Fraction between 0 and 1 (0.99 for p99).
+             * @return Upper bound of the matching bucket, or 0 if empty.
+             */
+            uint64_t percentile(double fraction);
+
+            /**
+             * @brief Counts a duration in the histogram.  Thread-safe.
+             * @param nanos Duration in nanoseconds; negative values count as 0.
+             */
+            void record(long long nanos)
+            {
+                auto index = bucket(nanos < 0 ? 0 : (uint64_t)nanos);
+                this->counts[index].fetch_add(1, std::memory_order_relaxed);
+            }
+    };
+
+    /**
+     * @brief Summary of a scheduler queue's activity over an interval.
+     * @author Zach Goethel
+     */
+    struct scheduler_snapshot
+    {
+        std::string name;
+
+        /**
+         * @brief Length of the interval in seconds.
+         */
+        double seconds = 0.0;
+
+        /**
+         * @brief Tasks completed within the interval, and their rate.
+         */
+        uint64_t tasks = 0;
+        double tasks_per_second = 0.0;
+
+        /**
+         * @brief Percentiles of time spent between enqueue and start, in
+         *      nanoseconds.
+         */
+        uint64_t wait_p50 = 0, wait_p99 = 0;
+
+        /**
+         * @brief Percentiles of time spent executing tasks, in nanoseconds.
+         */
+        uint64_t run_p50 = 0, run_p99 = 0;
+
+        /**
+         * @brief Tasks queued at the time of the snapshot, and the most queued
+         *      at once within the interval.
+         */
+        long long depth = 0, max_depth = 0;
+
+        /**
+         * @brief Formats the snapshot as a single line of log output.
+         */
+        std::string describe() const;
+    };
+
+    /**
+     * Counters and histograms describing one scheduler queue and the thread
+     * which executes it.  Producers report queued tasks; the executing thread
+     * reports each task's wait and run time.  All updates are relaxed atomic
+     * operations, so telemetry stays enabled in release builds.
+     *
+     * Snapshots report activity since the previous snapshot, so a periodic
+     * log line describes only its own interval.
+     *
+     * @brief Telemetry of a single worker's queue and execution.
+     * @author Zach Goethel
+     */
+    class scheduler_stats
+    {
+        private:
+            latency_histogram wait_time;
+            latency_histogram run_time;
+
+            std::atomic<uint64_t> completed { 0 };
+            std::atomic<long long> depth { 0 };
+            std::atomic<long long> max_depth { 0 };
+
+            /**
+             * @brief Guards the counts recorded at the previous snapshot.
+             */
+            std::mutex snapshot_mutex;
+
+            uint64_t last_wait[LATENCY_BUCKETS] = { };
+            uint64_t last_run[LATENCY_BUCKETS] = { };
+            uint64_t last_completed = 0;
+            long long last_snapshot = scheduler_now();
+
+        public:
+            /**
+             * @brief Reports tasks added to the queue.  Thread-safe.
+             * @param count Number of tasks added.
+             */
+            void enqueued(size_t count = 1);
+
+            /**
+             * @brief Reports a task removed from the queue.  Thread-safe.
+             */
+            void dequeued()
+            {
+                this->depth.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief Reports the timing of an executed task.
+             * @param enqueued Time at which the task was queued.
+             * @param started Time at which execution began.
+             * @param finished Time at which execution ended.
+             */
+            void executed(long long enqueued, long long started, long long finished)
+            {
+                this->wait_time.record(started - enqueued);
+                this->run_time.record(finished - started);
+                this->completed.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief Summarizes activity since the previous snapshot.
+             * @param name Name of the worker to report in the snapshot.
+             */
+            scheduler_snapshot snapshot(std::string name);
+    };
+}
@@ -1,6 +1,5 @@
 #pragma once
 
-#include <functional>
 
 #include "logger.h"
 #include "resource.h"
@@ -38,6 +37,15 @@ namespace lemon
         virtual void* map(bool read, bool write)
         { return nullptr; }
 
+        /**
+         * @brief Maps the buffer without waiting for the mapping to complete.
+         * @param read Whether the mapping will be read from.
+         * @param write Whether the mapping will be written to.
+         * @return Future of the mapped pointer.
+         */
+        virtual future<void*> map_async(bool read, bool write)
+        { return make_ready_future(map(read, write)); }
+
         template <typename T>
         T* map_typed(bool read, bool write)
         {
@@ -47,8 +55,8 @@ namespace lemon
         virtual void unmap()
         { }
 
-        template <typename T>
-        void map_scoped(bool read, bool write, std::function<void(T* mapped)> action)
+        template <typename T, typename F>
+        void map_scoped(bool read, bool write, F&& action)
         {
             std::lock_guard<std::mutex> lock(mutex);
 
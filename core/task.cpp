@@ -0,0 +1,86 @@
+#include "task.h"
+
+#include <mutex>
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+// Smallest pooled block size; closures below this size are stored inline
+#define TASK_POOL_MIN_BLOCK 128
+// Number of power-of-two block sizes kept in the pool (up to 4096 bytes)
+#define TASK_POOL_CLASSES 6
+
+namespace lemon
+{
+    /**
+     * @brief Free list of pooled blocks of a single size.
+     */
+    struct task_pool_class
+    {
+        std::mutex mutex;
+        void* free_list = nullptr;
+    };
+
+    task_pool_class* _task_pool()
+    {
+        static task_pool_class classes[TASK_POOL_CLASSES];
+        return classes;
+    }
+
+    // Finds the smallest size class which can hold the requested size
+    int _task_pool_class(size_t size)
+    {
+        size_t block = TASK_POOL_MIN_BLOCK;
+        for (int i = 0; i < TASK_POOL_CLASSES; i++, block <<= 1)
+            if (size <= block)
+                return i;
+
+        return -1;
+    }
+
+    void* task_pool_allocate(size_t size)
+    {
+        auto index = _task_pool_class(size);
+        if (index < 0)
+            return ::operator new(size);
+
+        auto& pool = _task_pool()[index];
+        {
+            std::lock_guard<std::mutex> lock(pool.mutex);
+
+            // Reuse a released block if one is available
+            if (pool.free_list != nullptr)
+            {
+                auto block = pool.free_list;
+                pool.free_list = *static_cast<void**>(block);
+                return block;
+            }
+        }
+
+        return ::operator new((size_t)TASK_POOL_MIN_BLOCK << index);
+    }
+
+    void task_pool_deallocate(void* block, size_t size)
+    {
+        auto index = _task_pool_class(size);
+        if (index < 0)
+        {
+            ::operator delete(block);
+            return;
+        }
+
+        auto& pool = _task_pool()[index];
+        std::lock_guard<std::mutex> lock(pool.mutex);
+
+        // Link the block at the front of the free list
+        *static_cast<void**>(block) = pool.free_list;
+        pool.free_list = block;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+// Bytes of closure state which a task can store without allocating
+#ifndef TASK_INLINE_SIZE
+#define TASK_INLINE_SIZE 64
+#endif
+
+namespace lemon
+{
+    /**
+     * Closures too large to be stored inline within a task are placed in
+     * blocks from this pool.  Blocks are grouped into power-of-two size classes
+     * and returned to a free list when released, so a steady workload stops
+     * reaching the global allocator after warming up.  Very large requests are
+     * passed directly through to the global allocator.
+     *
+     * @brief Allocates a pooled block for an oversized task closure.
+     * @param size Size of the closure in bytes.
+     * @return Pointer to a block of at least the requested size.
+     */
+    void* task_pool_allocate(size_t size);
+
+    /**
+     * @brief Returns a block allocated by the task pool to its free list.
+     * @param block Pointer previously returned by the task pool.
+     * @param size Size of the closure which was requested in bytes.
+     */
+    void task_pool_deallocate(void* block, size_t size);
+
+    /**
+     * A move-only replacement of `std::function<void()>` for queued work.  The
+     * callable is stored within the task itself when it fits in the inline
+     * buffer (`TASK_INLINE_SIZE` bytes), and in a pooled block otherwise.  As
+     * tasks cannot be copied, a closure is constructed once at the call site
+     * and then moved through queues until it is executed.
+     *
+     * @brief Allocation-free container for a single unit of work.
+     * @author Zach Goethel
+     */
+    class task
+    {
+        private:
+            /**
+             * @brief Type-erased operations for one stored callable type.
+             */
+            struct operations
+            {
+                void (*invoke)(void* storage);
+                void (*relocate)(void* to, void* from);
+                void (*destroy)(void* storage);
+            };
+
+            template <typename F>
+            static constexpr bool _fits_inline = sizeof(F) <= TASK_INLINE_SIZE
+                && alignof(F) <= alignof(std::max_align_t)
+                && std::is_nothrow_move_constructible_v<F>;
+
+            template <typename F>
+            static F* _inline(void* storage)
+            {
+                return std::launder(reinterpret_cast<F*>(storage));
+            }
+
+            template <typename F>
+            static F*& _pooled(void* storage)
+            {
+                return *reinterpret_cast<F**>(storage);
+            }
+
+            template <typename F>
+            static constexpr operations inline_operations =
+            {
+                [](void* storage) { (*_inline<F>(storage))(); },
+                [](void* to, void* from)
+                {
+                    new (to) F(std::move(*_inline<F>(from)));
+                    _inline<F>(from)->~F();
+                },
+                [](void* storage) { _inline<F>(storage)->~F(); }
+            };
+
+            template <typename F>
+            static constexpr operations pooled_operations =
+            {
+                [](void* storage) { (*_pooled<F>(storage))(); },
+                [](void* to, void* from) { _pooled<F>(to) = _pooled<F>(from); },
+                [](void* storage)
+                {
+                    _pooled<F>(storage)->~F();
+                    task_pool_deallocate(_pooled<F>(storage), sizeof(F));
+                }
+            };
+
+            alignas(std::max_align_t) unsigned char storage[TASK_INLINE_SIZE];
+
+            const operations* ops = nullptr;
+
+        public:
+            /**
+             * @brief Constructs an empty task which cannot be invoked.
+             */
+            task() = default;
+
+            /**
+             * @brief Constructs a task which will invoke the provided callable.
+             * @param fn Function, lambda or functor taking no arguments.
+             */
+            template <typename F, typename = std::enable_if_t<
+                !std::is_same_v<std::decay_t<F>, task>
+                && std::is_invocable_v<std::decay_t<F>&>>>
+            task(F&& fn)
+            {
+                using T = std::decay_t<F>;
+                static_assert(alignof(T) <= alignof(std::max_align_t),
+                    "Over-aligned closures are not supported");
+
+                if constexpr (_fits_inline<T>)
+                {
+                    new (storage) T(std::forward<F>(fn));
+                    ops = &inline_operations<T>;
+                } else
+                {
+                    _pooled<T>(storage) = new (task_pool_allocate(sizeof(T))) T(std::forward<F>(fn));
+                    ops = &pooled_operations<T>;
+                }
+            }
+
+            task(task&& other) noexcept
+            {
+                if (other.ops != nullptr)
+                {
+                    other.ops->relocate(storage, other.storage);
+                    ops = other.ops;
+                    other.ops = nullptr;
+                }
+            }
+
+            task& operator=(task&& other) noexcept
+            {
+                if (this != &other)
+                {
+                    this->reset();
+
+                    if (other.ops != nullptr)
+                    {
+                        other.ops->relocate(storage, other.storage);
+                        ops = other.ops;
+                        other.ops = nullptr;
+                    }
+                }
+
+                return *this;
+            }
+
+            task(const task&) = delete;
+            task& operator=(const task&) = delete;
+
+            ~task()
+            {
+                this->reset();
+            }
+
+            /**
+             * @brief Destroys the stored callable, leaving this task empty.
+             */
+            void reset()
+            {
+                if (ops != nullptr)
+                {
+                    ops->destroy(storage);
+                    ops = nullptr;
+                }
+            }
+
+            /**
+             * @brief Invokes the stored callable on the current thread.
+             */
+            void operator()()
+            {
+                if (ops == nullptr)
+                    throw std::bad_function_call();
+
+                ops->invoke(storage);
+            }
+
+            /**
+             * @brief Checks whether this task holds a callable.
+             * @return Whether this task may be invoked.
+             */
+            explicit operator bool() const
+            {
+                return ops != nullptr;
+            }
+    };
+}
\ No newline at end of file
@@ -0,0 +1,227 @@
+#include "task_graph.h"
+
+#include <stdexcept>
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+// Define shortened names for convenience
+typedef std::chrono::high_resolution_clock high_res;
+typedef std::chrono::duration<double> seconds_d;
+
+namespace lemon
+{
+    int task_graph::add(std::string name, task job)
+    {
+        auto node = std::make_unique<task_graph_node>();
+        node->name = name;
+        node->job = std::move(job);
+
+        this->nodes.push_back(std::move(node));
+        return (int)this->nodes.size() - 1;
+    }
+
+    bool task_graph::_reaches(int from, int to)
+    {
+        // Search iteratively, visiting each node at most once, so that wide
+        // or deep graphs neither revisit shared successors nor overflow
+        std::vector<bool> visited(this->nodes.size());
+        std::vector<int> stack { from };
+        visited[from] = true;
+
+        while (!stack.empty())
+        {
+            auto node = stack.back();
+            stack.pop_back();
+            if (node == to)
+                return true;
+
+            for (auto next : this->nodes[node]->successors)
+                if (!visited[next])
+                {
+                    visited[next] = true;
+                    stack.push_back(next);
+                }
+        }
+
+        return false;
+    }
+
+    void task_graph::precede(int before, int after)
+    {
+        auto count = (int)this->nodes.size();
+        if (before < 0 || before >= count || after < 0 || after >= count)
+            throw std::out_of_range("Task graph edge from " + std::to_string(before)
+                + " to " + std::to_string(after) + " names a job not in the graph");
+
+        // Reject edges which would leave jobs waiting on each other
+        if (this->_reaches(after, before))
+            throw std::runtime_error("Task graph edge from '" + this->nodes[before]->name
+                + "' to '" + this->nodes[after]->name + "' would create a cycle");
+
+        this->nodes[before]->successors.push_back(after);
+        this->nodes[after]->predecessors.push_back(before);
+    }
+
+    void task_graph::_ready(worker_pool& pool, const std::shared_ptr<task_graph_run>& run, int index)
+    {
+        {
+            std::lock_guard<std::mutex> lock(run->mutex);
+            run->ready.push_back(index);
+        }
+        run->changed.notify_one();
+
+        // Any worker may start the job, unless the running thread takes it
+        // first; the graph is only touched once a job has been taken
+        pool.execute([this, &pool, run]()
+        {
+            int next;
+            {
+                std::lock_guard<std::mutex> lock(run->mutex);
+                if (run->ready.empty())
+                    return;
+
+                next = run->ready.front();
+                run->ready.pop_front();
+            }
+
+            this->_run_node(pool, run, next);
+        });
+    }
+
+    void task_graph::_run_node(worker_pool& pool, const std::shared_ptr<task_graph_run>& run, int index)
+    {
+        auto& node = *this->nodes[index];
+
+        node.start = high_res::now();
+        try
+        {
+            node.job();
+        } catch(...)
+        {
+            std::lock_guard<std::mutex> lock(this->error_mutex);
+            if (!this->error)
+                this->error = std::current_exception();
+        }
+        node.end = high_res::now();
+
+        // Queue each successor once its last predecessor finishes
+        for (auto next : node.successors)
+            if (this->nodes[next]->pending.fetch_sub(1) == 1)
+                this->_ready(pool, run, next);
+
+        // The graph may be destroyed once the last job is counted
+        {
+            std::lock_guard<std::mutex> lock(run->mutex);
+            run->remaining--;
+        }
+        run->changed.notify_one();
+    }
+
+    void task_graph::run(worker_pool& pool)
+    {
+        if (this->nodes.empty())
+            return;
+        auto start = high_res::now();
+
+        // Reset dependency counts for this run before scheduling anything
+        this->error = nullptr;
+        auto run = std::make_shared<task_graph_run>();
+        run->remaining = (int)this->nodes.size();
+        for (auto& node : this->nodes)
+            node->pending = (int)node->predecessors.size();
+
+        for (int i = 0; i < (int)this->nodes.size(); i++)
+            if (this->nodes[i]->predecessors.empty())
+                this->_ready(pool, run, i);
+
+        // Run ready jobs here rather than idling, so that a worker of the pool
+        // running the graph does not hold up the jobs it waits on
+        std::unique_lock<std::mutex> lock(run->mutex);
+        while (true)
+        {
+            run->changed.wait(lock, [&]()
+            {
+                return !run->ready.empty() || run->remaining == 0;
+            });
+            if (run->remaining == 0)
+                break;
+
+            auto next = run->ready.front();
+            run->ready.pop_front();
+
+            lock.unlock();
+            this->_run_node(pool, run, next);
+            lock.lock();
+        }
+        lock.unlock();
+
+        this->last_run_time = seconds_d(high_res::now() - start).count();
+        this->_measure();
+
+        if (this->error)
+            std::rethrow_exception(this->error);
+    }
+
+    void task_graph::_measure()
+    {
+        auto count = this->nodes.size();
+        // Longest chain of run times ending at each node, and its prior link
+        std::vector<double> path_time(count, -1.0);
+        std::vector<int> path_prev(count, -1);
+
+        // Nodes are resolved once all predecessors are; the graph is acyclic
+        size_t resolved = 0;
+        while (resolved < count)
+            for (size_t i = 0; i < count; i++)
+            {
+                if (path_time[i] >= 0.0)
+                    continue;
+                auto& node = *this->nodes[i];
+
+                double longest = 0.0;
+                int prev = -1;
+                bool ready = true;
+
+                for (auto p : node.predecessors)
+                {
+                    if (path_time[p] < 0.0)
+                    {
+                        ready = false;
+                        break;
+                    }
+
+                    if (path_time[p] > longest)
+                    {
+                        longest = path_time[p];
+                        prev = p;
+                    }
+                }
+
+                if (!ready)
+                    continue;
+
+                path_time[i] = longest + seconds_d(node.end - node.start).count();
+                path_prev[i] = prev;
+                resolved++;
+            }
+
+        // Walk back from the node which finishes the longest chain
+        int last = 0;
+        for (size_t i = 1; i < count; i++)
+            if (path_time[i] > path_time[last])
+                last = (int)i;
+
+        this->last_critical_time = path_time[last];
+        this->last_critical_path.clear();
+        for (int i = last; i >= 0; i = path_prev[i])
+            this->last_critical_path.insert(this->last_critical_path.begin(), this->nodes[i]->name);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "task.h"
+#include "worker_thread.h"
+#include "logger.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace lemon
+{
+    /**
+     * @brief A single job within a task graph and its dependency edges.
+     * @author Zach Goethel
+     */
+    struct task_graph_node
+    {
+        std::string name;
+        task job;
+
+        std::vector<int> predecessors;
+        std::vector<int> successors;
+
+        /**
+         * @brief Predecessors which have not yet completed in this run.
+         */
+        std::atomic<int> pending { 0 };
+
+        /**
+         * @brief Start and end times of this job in the most recent run.
+         */
+        std::chrono::high_resolution_clock::time_point start, end;
+    };
+
+    /**
+     * Shared with the pool tasks which start jobs, so that a task which finds
+     * no job left to start only touches this state and not the graph.
+     * 
+     * @brief Jobs of a single graph run which are ready to start.
+     */
+    struct task_graph_run
+    {
+        std::mutex mutex;
+
+        /**
+         * @brief Notified when a job becomes ready or the last job finishes.
+         */
+        std::condition_variable changed;
+
+        std::deque<int> ready;
+
+        /**
+         * @brief Jobs which have not yet completed in this run.
+         */
+        int remaining = 0;
+    };
+
+    /**
+     * A set of jobs with declared dependencies which is built once and then
+     * executed repeatedly, such as once per frame.  Each job is scheduled on
+     * a worker pool as soon as all of the jobs it depends upon have finished,
+     * so independent jobs run concurrently.  The thread running the graph
+     * also starts ready jobs while it waits, so a graph may be run from one
+     * of the pool's own workers.
+     *
+     * After each run, the critical path (the chain of dependent jobs with the
+     * longest total run time) is computed from the measured job durations.
+     * This is the lower bound on the time to run the graph, and the chain of
+     * jobs worth optimizing or splitting first.
+     *
+     * Nodes and edges should not be modified while the graph is running.
+     *
+     * @brief Dependency graph of jobs which can be re-run on a worker pool.
+     * @author Zach Goethel
+     */
+    class task_graph
+    {
+        private:
+            std::vector<std::unique_ptr<task_graph_node>> nodes;
+
+            std::mutex error_mutex;
+            std::exception_ptr error;
+
+            /**
+             * @brief Names of the jobs on the critical path of the last run.
+             */
+            std::vector<std::string> last_critical_path;
+
+            /**
+             * @brief Total run time of the critical path of the last run.
+             */
+            double last_critical_time = 0.0;
+
+            /**
+             * @brief Total wall time of the last run in seconds.
+             */
+            double last_run_time = 0.0;
+
+            logger log { "Task Graph" };
+
+            /**
+             * @brief Queues a job whose predecessors have all completed, and
+             *      a pool task which starts it unless the caller does first.
+             */
+            void _ready(worker_pool& pool, const std::shared_ptr<task_graph_run>& run, int index);
+
+            /**
+             * @brief Runs a job and queues successors which become ready.
+             */
+            void _run_node(worker_pool& pool, const std::shared_ptr<task_graph_run>& run, int index);
+
+            /**
+             * @brief Computes the critical path from recorded job times.
+             */
+            void _measure();
+
+            /**
+             * @brief Checks whether the second node is reachable from the first.
+             */
+            bool _reaches(int from, int to);
+
+        public:
+            /**
+             * @brief Adds a job to the graph with no dependencies.
+             * @param name Name used when reporting the critical path.
+             * @param job Function to execute each time the graph is run.
+             * @return Index identifying the node within this graph.
+             */
+            int add(std::string name, task job);
+
+            /**
+             * @brief Declares that one job must finish before another starts.
+             * @param before Index of the job which must complete first.
+             * @param after Index of the job which depends upon the first.
+             * @throws std::out_of_range If either index is not a job of this
+             *      graph.
+             * @throws std::runtime_error If the edge would create a cycle.
+             */
+            void precede(int before, int after);
+
+            /**
+             * Schedules every job of the graph on the provided pool in
+             * dependency order, and runs ready jobs on the calling thread until
+             * all jobs have completed.  The first exception thrown by any job
+             * is rethrown once the run has finished; jobs depending on a
+             * failed job still run.
+             *
+             * @brief Executes all jobs of the graph on the provided pool.
+             * @param pool Worker pool on which to schedule jobs.
+             */
+            void run(worker_pool& pool);
+
+            /**
+             * @brief Checks whether any jobs have been added to this graph.
+             */
+            bool empty()
+            { return nodes.empty(); }
+
+            /**
+             * @brief Names of the jobs on the critical path of the last run.
+             */
+            const std::vector<std::string>& critical_path()
+            { return last_critical_path; }
+
+            /**
+             * @brief Sum of job run times along the critical path in seconds.
+             */
+            double critical_time()
+            { return last_critical_time; }
+
+            /**
+             * @brief Wall time of the last run of the graph in seconds.
+             */
+            double run_time()
+            { return last_run_time; }
+    };
+}
\ No newline at end of file
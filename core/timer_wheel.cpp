@@ -0,0 +1,109 @@
+#include "timer_wheel.h"
+
+#include "scheduler_stats.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace lemon
+{
+    timer_wheel::timer_wheel()
+    {
+        this->epoch = scheduler_now();
+    }
+
+    void timer_wheel::_insert(timer_entry entry)
+    {
+        // Expired timers fire on the tick currently being processed
+        auto expiry = std::max(entry.expiry, this->current);
+        auto delta = expiry - this->current;
+        this->count++;
+
+        for (int level = 0; level < TIMER_WHEEL_LEVELS; level++)
+        {
+            auto shift = TIMER_WHEEL_BITS * level;
+            if (delta < ((long long)1 << (shift + TIMER_WHEEL_BITS)))
+            {
+                this->slots[level][(expiry >> shift) & (TIMER_WHEEL_SLOTS - 1)].push_back(std::move(entry));
+                return;
+            }
+        }
+
+        // Beyond the range of the wheel; park in the farthest slot of the
+        // highest level, to be cascaded and placed again later
+        auto shift = TIMER_WHEEL_BITS * (TIMER_WHEEL_LEVELS - 1);
+        auto farthest = this->current + ((long long)1 << (shift + TIMER_WHEEL_BITS)) - 1;
+        this->slots[TIMER_WHEEL_LEVELS - 1][(farthest >> shift) & (TIMER_WHEEL_SLOTS - 1)].push_back(std::move(entry));
+    }
+
+    void timer_wheel::_cascade(int level)
+    {
+        auto shift = TIMER_WHEEL_BITS * level;
+        auto& slot = this->slots[level][(this->current >> shift) & (TIMER_WHEEL_SLOTS - 1)];
+
+        auto entries = std::move(slot);
+        slot.clear();
+
+        for (auto& entry : entries)
+        {
+            this->count--;
+            this->_insert(std::move(entry));
+        }
+    }
+
+    void timer_wheel::add(long long deadline, long long period, task job,
+        std::shared_ptr<std::atomic<bool>> cancelled)
+    {
+        timer_entry entry;
+        entry.job = std::move(job);
+        entry.deadline = deadline;
+        entry.period = period;
+        // The current tick has already fired
+        entry.expiry = std::max(this->_tick_of(deadline), this->current + 1);
+        entry.cancelled = std::move(cancelled);
+
+        this->_insert(std::move(entry));
+    }
+
+    long long timer_wheel::next_deadline()
+    {
+        if (this->count == 0)
+            return -1;
+
+        long long earliest = -1;
+
+        // Timers of the lowest level are due exactly at their tick
+        for (long long tick = this->current + 1; tick < this->current + TIMER_WHEEL_SLOTS; tick++)
+            if (!this->slots[0][tick & (TIMER_WHEEL_SLOTS - 1)].empty())
+            {
+                earliest = this->epoch + tick * TIMER_TICK_NS;
+                break;
+            }
+
+        // Timers of higher levels are due no earlier than their cascade
+        for (int level = 1; level < TIMER_WHEEL_LEVELS; level++)
+        {
+            auto shift = TIMER_WHEEL_BITS * level;
+            for (long long lap = 1; lap <= TIMER_WHEEL_SLOTS; lap++)
+            {
+                auto index = (this->current >> shift) + lap;
+                if (this->slots[level][index & (TIMER_WHEEL_SLOTS - 1)].empty())
+                    continue;
+
+                auto cascade = this->epoch + (index << shift) * TIMER_TICK_NS;
+                if (earliest < 0 || cascade < earliest)
+                    earliest = cascade;
+                break;
+            }
+        }
+
+        return earliest;
+    }
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "task.h"
+
+// Resolution of timers, in nanoseconds
+#ifndef TIMER_TICK_NS
+    #define TIMER_TICK_NS 1000000
+#endif
+// Slots per level of the timer wheel, and the bits indexing them
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+// Levels of the timer wheel; each level's slot spans a lap of the level below
+#define TIMER_WHEEL_LEVELS 4
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace lemon
+{
+    /**
+     * Returned when scheduling a delayed or periodic task.  Cancelling is
+     * thread-safe; a cancelled task will not run again, though a run which has
+     * already started is not interrupted.
+     *
+     * @brief Handle which can cancel a scheduled timer.
+     * @author Zach Goethel
+     */
+    class timer_handle
+    {
+        public:
+            std::shared_ptr<std::atomic<bool>> flag = std::make_shared<std::atomic<bool>>(false);
+
+            /**
+             * @brief Prevents any further runs of the timer's task.
+             */
+            void cancel()
+            {
+                this->flag->store(true);
+            }
+
+            /**
+             * @brief Checks whether the timer has been cancelled.
+             */
+            bool cancelled() const
+            {
+                return this->flag->load();
+            }
+    };
+
+    /**
+     * @brief A task scheduled in a timer wheel.
+     */
+    struct timer_entry
+    {
+        task job;
+
+        /**
+         * @brief Time at which the task is due, in nanoseconds.
+         */
+        long long deadline;
+
+        /**
+         * @brief Interval at which the task repeats, or zero to run once.
+         */
+        long long period;
+
+        /**
+         * @brief Tick at which the task is due.
+         */
+        long long expiry;
+
+        std::shared_ptr<std::atomic<bool>> cancelled;
+    };
+
+    /**
+     * A hierarchical timing wheel.  The lowest level holds timers due within
+     * the next lap of ticks, one slot per tick; each higher level holds timers
+     * due within a lap of the level below, one slot per such lap.  When the
+     * lowest level wraps, the matching slot of the next level is cascaded down,
+     * so adding, cancelling and expiring a timer each take constant time.
+     *
+     * Timers fire on the first advance at or after their deadline, rounded up
+     * to the next tick (`TIMER_TICK_NS`).  The wheel is not thread-safe; it is
+     * owned by the single thread which advances it.
+     *
+     * @brief Schedules delayed and periodic tasks in constant time.
+     * @author Zach Goethel
+     */
+    class timer_wheel
+    {
+        private:
+            std::vector<timer_entry> slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+
+            /**
+             * @brief Time from which ticks are counted, in nanoseconds.
+             */
+            long long epoch;
+
+            /**
+             * @brief Most recent tick which has been fired.
+             */
+            long long current = 0;
+
+            /**
+             * @brief Number of timers held across all slots.
+             */
+            size_t count = 0;
+
+            /**
+             * @brief Places a timer in the slot matching its expiry tick.
+             */
+            void _insert(timer_entry entry);
+
+            /**
+             * @brief Redistributes a slot of a higher level into lower levels.
+             */
+            void _cascade(int level);
+
+            /**
+             * @brief First tick at or after the provided time.
+             */
+            long long _tick_of(long long time)
+            {
+                return (time - this->epoch + TIMER_TICK_NS - 1) / TIMER_TICK_NS;
+            }
+
+        public:
+            timer_wheel();
+
+            /**
+             * @brief Schedules a task in the wheel.
+             * @param deadline Time at which the task is due, in nanoseconds.
+             * @param period Interval at which the task repeats, or zero.
+             * @param job Task to run once due.
+             * @param cancelled Flag which, once set, discards the timer.
+             */
+            void add(long long deadline, long long period, task job,
+                std::shared_ptr<std::atomic<bool>> cancelled);
+
+            /**
+             * @brief Checks whether no timers are scheduled.
+             */
+            bool empty()
+            {
+                return this->count == 0;
+            }
+
+            /**
+             * Timers held in higher levels report the time of their cascade,
+             * which may be earlier than their actual deadline.  Waking early
+             * only advances the wheel, after which the next deadline is exact.
+             *
+             * @brief Finds a time by which the wheel should next be advanced.
+             * @return Time in nanoseconds, or a negative value if empty.
+             */
+            long long next_deadline();
+
+            /**
+             * Fires every timer which is due by the provided time, in order of
+             * expiry.  Periodic timers are rescheduled after they run; if runs
+             * fell behind, missed periods are skipped rather than run in a
+             * burst.
+             *
+             * @brief Advances the wheel, running each timer which is due.
+             * @param now Current time, as from `scheduler_now`.
+             * @param run Function invoked with each due task.
+             */
+            template <typename F>
+            void advance(long long now, F&& run)
+            {
+                auto target = (now - this->epoch) / TIMER_TICK_NS;
+
+                // Skip ahead when there is nothing to fire
+                if (this->count == 0)
+                    this->current = std::max(this->current, target);
+
+                while (this->current < target)
+                {
+                    this->current++;
+
+                    // Cascade each level whose lap below has just wrapped,
+                    // starting from the highest
+                    for (int level = TIMER_WHEEL_LEVELS - 1; level > 0; level--)
+                        if ((this->current & (((long long)1 << (TIMER_WHEEL_BITS * level)) - 1)) == 0)
+                            this->_cascade(level);
+
+                    auto due = std::move(this->slots[0][this->current & (TIMER_WHEEL_SLOTS - 1)]);
+                    this->slots[0][this->current & (TIMER_WHEEL_SLOTS - 1)].clear();
+
+                    for (auto& entry : due)
+                    {
+                        if (!entry.cancelled->load(std::memory_order_relaxed))
+                            run(entry.job);
+
+                        if (entry.period <= 0 || entry.cancelled->load(std::memory_order_relaxed))
+                        {
+                            this->count--;
+                            continue;
+                        }
+
+                        // Skip any periods which have already been missed
+                        entry.deadline += entry.period;
+                        if (entry.deadline <= now)
+                            entry.deadline = now + entry.period;
+
+                        entry.expiry = std::max(this->_tick_of(entry.deadline), this->current + 1);
+                        this->count--;
+                        this->_insert(std::move(entry));
+                    }
+                }
+            }
+    };
+}
@@ -2,7 +2,12 @@
 
 #include <chrono>
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+#endif
+
 #include "logger.h"
+#include "profiler.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 //                          Lemon 3D Graphics Engine                          //
@@ -14,8 +19,23 @@
 //  ------------------------------------------------------------------------  //
 ////////////////////////////////////////////////////////////////////////////////
 
+// Define shortened names for convenience
+typedef std::chrono::steady_clock steady;
+
 namespace lemon
 {
+    /**
+     * @brief Hints to the processor that the thread is spin-waiting.
+     */
+    inline void _cpu_relax()
+    {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield");
+#endif
+    }
+
     // Synchronization objects for awaiting task execution
     thread_local std::mutex await_mutex;
 
@@ -36,30 +56,336 @@ namespace lemon
         is_parked = true;
         thread_id = std::this_thread::get_id();
 
+        timed_task next;
+        int lane;
+
+        // Runs a due timer's task without consuming it, as it may repeat
+        auto fire = [this](task& job)
+        {
+            LEMON_PROFILE_SCOPE("Timer");
+            this->_run(job);
+        };
         // Loop until the park flag is disabled (likely infinite)
         while (is_parked)
         {
-            semaphore.acquire();
+            this->timers.advance(scheduler_now(), fire);
 
-            try
+            // Drain every runnable task before waiting again
+            while (this->_poll_next(next, lane))
             {
-                this->execution_queue.poll()();
-            } catch(const std::exception& ex)
+                this->stats.dequeued();
+                auto start = scheduler_now();
+
+                {
+                    LEMON_PROFILE_SCOPE(this->task_names[lane]);
+                    this->_run(next.job);
+                    next.job.reset();
+                }
+
+                auto end = scheduler_now();
+                this->stats.executed(next.enqueued, start, end);
+                this->spent[lane] += std::chrono::nanoseconds(end - start);
+
+                // Keep timers punctual while a long backlog drains
+                this->timers.advance(end, fire);
+            }
+
+            this->_wait();
+        }
+    }
+
+    void worker_thread::_run(task& job)
+    {
+        try
+        {
+            job();
+        } catch(const std::exception& ex)
+        {
+            auto error = ex.what();
+            log.error(error);
+        }
+    }
+
+    void worker_thread::_spill(int lane, timed_task&& next)
+    {
+        std::lock_guard<std::mutex> lock(this->overflow_mutex);
+        this->overflow[lane].push_back(std::move(next));
+
+        this->overflowed[lane].fetch_add(1, std::memory_order_release);
+    }
+
+    void worker_thread::_spill(int lane, task* tasks, size_t count)
+    {
+        std::lock_guard<std::mutex> lock(this->overflow_mutex);
+        for (size_t i = 0; i < count; i++)
+            this->overflow[lane].emplace_back(std::move(tasks[i]));
+
+        this->overflowed[lane].fetch_add(count, std::memory_order_release);
+    }
+
+    bool worker_thread::_unspill(int lane, timed_task& next)
+    {
+        if (this->overflowed[lane].load(std::memory_order_acquire) == 0)
+            return false;
+
+        std::lock_guard<std::mutex> lock(this->overflow_mutex);
+        next = std::move(this->overflow[lane].front());
+        this->overflow[lane].pop_front();
+
+        this->overflowed[lane].fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+
+    bool worker_thread::_lane_empty(int lane)
+    {
+        return this->execution_queues[lane].empty()
+            && this->overflowed[lane].load(std::memory_order_acquire) == 0;
+    }
+
+    bool worker_thread::_runnable(int lane)
+    {
+        if (this->_lane_empty(lane))
+            return false;
+
+        auto budget = this->budgets[lane].load(std::memory_order_relaxed);
+        return budget <= 0 || this->spent[lane].count() < budget;
+    }
+
+    bool worker_thread::_has_runnable()
+    {
+        for (int lane = 0; lane < TASK_PRIORITIES; lane++)
+            if (this->_runnable(lane))
+                return true;
+
+        return false;
+    }
+
+    bool worker_thread::_poll_next(timed_task& next, int& lane)
+    {
+        lane = -1;
+
+        // Give a turn to the lowest lane which has waited too long
+        for (int i = TASK_PRIORITIES - 1; i > 0 && lane < 0; i--)
+            if (this->skipped[i] >= WORKER_STARVATION_LIMIT && this->_runnable(i))
+                lane = i;
+        // Otherwise, run from the highest runnable lane
+        for (int i = 0; i < TASK_PRIORITIES && lane < 0; i++)
+            if (this->_runnable(i))
+                lane = i;
+
+        // Overflowed tasks were added after those in the lock-free queue
+        if (lane < 0 || !(this->execution_queues[lane].try_poll(next) || this->_unspill(lane, next)))
+            return false;
+
+        // Count the turn against each lower lane with work waiting
+        this->skipped[lane] = 0;
+        for (int i = lane + 1; i < TASK_PRIORITIES; i++)
+            if (!this->_lane_empty(i))
+                this->skipped[i]++;
+
+        return true;
+    }
+
+    void worker_thread::_wake()
+    {
+        // Order the task's publication before reading the sleeping flag
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (this->sleeping.load(std::memory_order_relaxed)
+                && this->sleeping.exchange(false))
+        {
+            if (auto waiter = this->waiter.load())
             {
-                auto error = ex.what();
-                log.error(error);
+                waiter->wake();
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(this->wake_mutex);
+                this->woken = true;
+            }
+
+            this->wake.notify_one();
+        }
+    }
+
+    void worker_thread::_wait()
+    {
+        auto start = scheduler_now();
+        auto limit = this->spin_limit.load(std::memory_order_relaxed);
+        // Time at which the next timer is due, if any
+        auto due = this->timers.next_deadline();
+        bool found = false;
+
+        if (limit > 0)
+        {
+            // Spin while the next task is likely to arrive shortly, reading
+            // the clock only once every few iterations
+            auto deadline = start + std::min(this->spin_window, limit);
+            if (due >= 0)
+                deadline = std::min(deadline, due);
+
+            for (int i = 1; !found; i++)
+                if (this->_has_runnable())
+                    found = true;
+                else if (i % 64 == 0 && scheduler_now() >= deadline)
+                    break;
+                else
+                    _cpu_relax();
+
+            // Give up the processor a few times before blocking
+            for (int i = 0; !found && i < WORKER_YIELD_COUNT; i++)
+            {
+                std::this_thread::yield();
+                found = this->_has_runnable();
             }
         }
+
+        if (!found)
+            this->_block(due);
+
+        // Adapt the spin to the gap which has just passed
+        auto gap = scheduler_now() - start;
+        if (gap < limit)
+            this->spin_window = std::max(this->spin_window, std::min(limit, gap * 2));
+        else
+            this->spin_window /= 2;
+    }
+
+    void worker_thread::_block(long long until)
+    {
+        this->sleeping.store(true, std::memory_order_relaxed);
+        // Order the flag before checking the queue a final time
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        // A task may have been published before the flag was visible; cancel
+        // the wait unless an adding thread has already claimed the wakeup
+        if (this->_has_runnable() && this->sleeping.exchange(false))
+            return;
+
+        if (auto waiter = this->waiter.load())
+        {
+            waiter->wait(until);
+            // A wakeup claimed by an adding thread may still be delivered
+            // later, which only causes one spurious return from the waiter
+            this->sleeping.store(false);
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(this->wake_mutex);
+        auto signalled = [this]()
+        {
+            return this->woken;
+        };
+
+        if (until < 0)
+            this->wake.wait(lock, signalled);
+        else
+        {
+            // Wake for the next timer, withdrawing the flag on timeout unless
+            // an adding thread has already claimed the wakeup
+            auto timeout = steady::time_point(std::chrono::nanoseconds(until));
+            if (!this->wake.wait_until(lock, timeout, signalled))
+            {
+                if (this->sleeping.exchange(false))
+                    return;
+                this->wake.wait(lock, signalled);
+            }
+        }
+
+        this->woken = false;
+    }
+
+    void worker_thread::execute(task task, task_priority priority)
+    {
+        auto lane = (int)priority;
+        timed_task next(std::move(task));
+
+        // Count before publishing, so the task's dequeue can not be counted
+        // first and leave the depth negative
+        this->stats.enqueued();
+        // Queue the provided task, following any tasks which have spilled
+        if (this->overflowed[lane].load(std::memory_order_acquire) > 0
+                || !this->execution_queues[lane].try_add(std::move(next)))
+            this->_spill(lane, std::move(next));
+        this->_wake();
+    }
+
+    void worker_thread::execute_batch(task* tasks, size_t count, task_priority priority)
+    {
+        auto lane = (int)priority;
+
+        // Count before publishing, as for a single task
+        this->stats.enqueued(count);
+        // Spill the whole batch if it does not fit, keeping it in order
+        if (this->overflowed[lane].load(std::memory_order_acquire) > 0
+                || !this->execution_queues[lane].try_add_all(tasks, count))
+            this->_spill(lane, tasks, count);
+        this->_wake();
+    }
+
+    void worker_thread::set_budget(task_priority priority, std::chrono::nanoseconds budget)
+    {
+        this->budgets[(int)priority].store(budget.count());
+        // A lane may have become runnable while the parked thread sleeps
+        this->_wake();
+    }
+
+    timer_handle worker_thread::execute_after(std::chrono::nanoseconds delay, task job)
+    {
+        return this->_schedule_timer(delay, 0, std::move(job));
+    }
+
+    timer_handle worker_thread::execute_every(std::chrono::nanoseconds period, task job)
+    {
+        return this->_schedule_timer(period, period.count(), std::move(job));
+    }
+
+    timer_handle worker_thread::_schedule_timer(std::chrono::nanoseconds delay, long long period, task job)
+    {
+        timer_handle handle;
+        auto deadline = scheduler_now() + delay.count();
+
+        // The wheel belongs to the parked thread; hand the timer over as a task
+        this->execute([this, deadline, period, job = std::move(job), cancelled = handle.flag]() mutable
+        {
+            this->timers.add(deadline, period, std::move(job), std::move(cancelled));
+        }, task_priority::high);
+
+        return handle;
     }
 
-    void worker_thread::execute(std::function<void()> task)
+    void worker_thread::set_spin_limit(std::chrono::nanoseconds limit)
     {
-        // Queue the provided task
-        this->execution_queue.add(task);
-        semaphore.release();
+        this->spin_limit.store(std::max((long long)limit.count(), 0LL));
     }
 
-    void worker_thread::execute_wait(std::function<void()> task)
+    void worker_thread::begin_frame()
+    {
+        for (auto& lane : this->spent)
+            lane = std::chrono::nanoseconds::zero();
+    }
+
+    void thread_awaiter::await_suspend(std::coroutine_handle<> handle)
+    {
+        this->thread.execute([handle]()
+        {
+            handle.resume();
+        }, this->priority);
+    }
+
+    void worker_thread::pin(std::vector<int> cpus)
+    {
+        this->execute([this, cpus = std::move(cpus)]()
+        {
+            if (pin_current_thread(cpus))
+                log.debug("Pinned worker thread to processors {}", describe_cpus(cpus));
+            else
+                log.warn("Could not pin worker thread to processors {}", describe_cpus(cpus));
+        });
+    }
+
+    void worker_thread::execute_wait(task task, task_priority priority)
     {
         // Protection for a thread queueing onto itself
         if (std::this_thread::get_id() == this->thread_id)
@@ -85,41 +411,211 @@ namespace lemon
             task();
 
             l.release();
-        });
+        }, priority);
 
         l.acquire();
     }
 
-    worker_pool::worker_pool(int num_workers)
+    // Pool and index of the pool worker running on the current thread
+    thread_local worker_pool* current_pool = nullptr;
+    thread_local int current_index = -1;
+
+    worker_pool::worker_pool(int num_workers, worker_placement placement)
     {
-        log.debug("Starting up a thread pool with " + std::to_string(num_workers) + " members");
+        // Always start at least one worker thread
+        if (num_workers < 1)
+            num_workers = 1;
+
+        log.debug("Starting up a thread pool with {} members", num_workers);
 
         // Store the number of worker threads
         this->num_workers = num_workers;
-        // Allocate the array of threads
-        this->workers = new worker_thread*[num_workers];
+        // Allocate the local queue of each thread
+        this->queues = new deque<timed_task>[num_workers];
+        this->stats = new scheduler_stats[num_workers];
+        this->threads = new std::thread[num_workers];
+
+        auto& topology = cpu_topology::system();
+        if (logger::enabled(log_level::debug))
+            log.debug("Host topology: {}", topology.describe());
+        auto placements = placement.assign(topology, num_workers);
 
         // Initialize the pool of worker threads
         for (int i = 0; i < num_workers; i++)
-            this->workers[i] = new worker_thread(true);
+        {
+            if (!placements[i].empty() && logger::enabled(log_level::debug))
+                log.debug("Binding pool worker {} to processors {}", i, describe_cpus(placements[i]));
+
+            this->threads[i] = std::thread([this, i, cpus = placements[i]]()
+            {
+                if (!cpus.empty() && !pin_current_thread(cpus))
+                    log.warn("Could not bind pool worker {} to processors {}", i, describe_cpus(cpus));
+
+                this->_work(i);
+            });
+        }
     }
 
     worker_pool::~worker_pool()
     {
-        // Free each individual worker
+        // Wake each worker to observe the shutdown
+        this->running = false;
+        this->pending.release(this->num_workers);
+
         for (int i = 0; i < this->num_workers; i++)
-            delete this->workers[i];
-        // Free the worker array memory
-        delete[] workers;
+            this->threads[i].join();
+        // Free the worker and queue arrays
+        delete[] threads;
+        delete[] queues;
+        delete[] stats;
+    }
+
+    timed_task worker_pool::_take(int index)
+    {
+        timed_task next;
+
+        // A pending task exists, but may be claimed by another worker between
+        // checks of two queues; keep searching until one is found
+        while (true)
+        {
+            // Take the newest task of the local queue first
+            if (this->queues[index].try_poll(next))
+            {
+                this->stats[index].dequeued();
+                return next;
+            }
+
+            // Take the oldest task submitted from outside the pool
+            if (this->injector.try_poll(next))
+            {
+                this->injector_stats.dequeued();
+                return next;
+            }
+
+            // Steal the oldest task of another worker's queue
+            for (int i = 1; i < this->num_workers; i++)
+            {
+                auto victim = (index + i) % this->num_workers;
+                if (this->queues[victim].try_poll_last(next))
+                {
+                    this->stats[victim].dequeued();
+                    return next;
+                }
+            }
+
+            std::this_thread::yield();
+        }
+    }
+
+    void worker_pool::_work(int index)
+    {
+        current_pool = this;
+        current_index = index;
+        profiler::name_thread("Pool worker " + std::to_string(index));
+
+        while (true)
+        {
+            this->pending.acquire();
+            if (!this->running)
+                break;
+
+            auto next = this->_take(index);
+            auto start = scheduler_now();
+
+            try
+            {
+                LEMON_PROFILE_SCOPE("Pool task");
+                next.job();
+            } catch(const std::exception& ex)
+            {
+                auto error = ex.what();
+                log.error(error);
+            }
+
+            this->stats[index].executed(next.enqueued, start, scheduler_now());
+        }
     }
 
-    //TODO BETTER LOAD BALANCING
-    void worker_pool::execute(std::function<void()> task)
+    void worker_pool::execute(task task)
     {
-        // Select the next round-robin thread
-        auto worker_index = this->round_robin.fetch_add(1) % this->num_workers;
-        auto worker = this->workers[worker_index];
-        // Enqueue the provied task in that thread
-        worker->execute(task);
+        if (current_pool == this)
+        {
+            // Keep tasks from a worker on its own queue for locality
+            this->stats[current_index].enqueued();
+            this->queues[current_index].push(std::move(task));
+        } else
+        {
+            // Queue external submissions in order for any idle worker
+            this->injector_stats.enqueued();
+            this->injector.add(std::move(task));
+        }
+
+        this->pending.release();
+    }
+
+    void worker_pool::execute_batch(task* tasks, size_t count)
+    {
+        if (count == 0)
+            return;
+
+        if (current_pool == this)
+        {
+            this->stats[current_index].enqueued(count);
+            // Only the owner adds to its queue, and only at the front
+            this->queues[current_index].push_all(tasks, count);
+        } else
+        {
+            this->injector_stats.enqueued(count);
+            this->injector.add_all(tasks, count);
+        }
+
+        this->pending.release(count);
+    }
+
+    /**
+     * @brief Worker thread which keeps the timers of every worker pool.
+     */
+    worker_thread& _pool_timer_thread()
+    {
+        static worker_thread timers(true);
+        // Name the thread's profile track once
+        [[maybe_unused]] static bool named = (timers.execute([]()
+        {
+            profiler::name_thread("Pool timers");
+        }), true);
+
+        return timers;
+    }
+
+    timer_handle worker_pool::execute_after(std::chrono::nanoseconds delay, task job)
+    {
+        return _pool_timer_thread().execute_after(delay, [this, job = std::move(job)]() mutable
+        {
+            this->execute(std::move(job));
+        });
+    }
+
+    timer_handle worker_pool::execute_every(std::chrono::nanoseconds period, task job)
+    {
+        auto shared = std::make_shared<task>(std::move(job));
+
+        return _pool_timer_thread().execute_every(period, [this, shared]()
+        {
+            this->execute([shared]()
+            {
+                (*shared)();
+            });
+        });
+    }
+
+    std::vector<scheduler_snapshot> worker_pool::snapshot()
+    {
+        std::vector<scheduler_snapshot> result;
+
+        for (int i = 0; i < this->num_workers; i++)
+            result.push_back(this->stats[i].snapshot("Pool worker " + std::to_string(i)));
+        result.push_back(this->injector_stats.snapshot("Pool injector"));
+
+        return result;
     }
 }
\ No newline at end of file
@@ -1,13 +1,35 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
-#include <functional>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <mutex>
 #include <thread>
 
 #include "sem_polyfill.h"
 #include "logger.h"
 #include "deque.h"
+#include "mpsc_queue.h"
+#include "task.h"
+#include "future.h"
+#include "coroutine.h"
+#include "cpu_topology.h"
+#include "scheduler_stats.h"
+#include "timer_wheel.h"
+
+// Tasks which fit in each lane's lock-free queue before spilling over
+#define WORKER_QUEUE_CAPACITY 1024
+// Higher-priority tasks which may run before a waiting lower lane gets a turn
+#define WORKER_STARVATION_LIMIT 32
+// Longest time an idle worker thread spins before blocking, in nanoseconds
+#ifndef WORKER_SPIN_LIMIT_NS
+    #define WORKER_SPIN_LIMIT_NS 50000
+#endif
+// Number of times an idle worker thread yields between spinning and blocking
+#define WORKER_YIELD_COUNT 4
 
 ////////////////////////////////////////////////////////////////////////////////
 //                          Lemon 3D Graphics Engine                          //
@@ -21,6 +43,85 @@
 
 namespace lemon
 {
+    /**
+     * Each worker thread keeps one queue per priority level.  Higher lanes are
+     * drained first, but a lower lane which has waited behind too many tasks
+     * is given a turn, so no lane is starved indefinitely.
+     * 
+     * @brief Priority lane of a task queued on a worker thread.
+     */
+    enum class task_priority
+    {
+        high = 0,
+        normal = 1,
+        low = 2
+    };
+
+    // Number of priority lanes of each worker thread
+    #define TASK_PRIORITIES 3
+
+    class worker_thread;
+
+    /**
+     * Like `schedule_awaiter`, but queues the coroutine's resumption in a
+     * specific priority lane of a worker thread.
+     * 
+     * @brief Awaitable which moves a coroutine onto a worker thread lane.
+     * @author Zach Goethel
+     */
+    struct thread_awaiter
+    {
+        worker_thread& thread;
+
+        /**
+         * @brief Set when the coroutine may continue without suspending.
+         */
+        bool already_there = false;
+
+        task_priority priority = task_priority::normal;
+
+        bool await_ready()
+        { return already_there; }
+
+        void await_suspend(std::coroutine_handle<> handle);
+
+        void await_resume()
+        { }
+    };
+
+    /**
+     * Some libraries require their thread to block in the library's own event
+     * loop (for example, GLFW's `glfwWaitEvents`).  An idle waiter installed
+     * on a worker thread replaces its blocking wait, so the thread sleeps in
+     * the library's loop and is woken through the library when a task is
+     * queued or a timer is due.
+     * 
+     * @brief Blocking wait of a worker thread provided by a library.
+     * @author Zach Goethel
+     */
+    class idle_waiter
+    {
+        public:
+            virtual ~idle_waiter()
+            { }
+
+            /**
+             * May return early (spuriously); the worker thread checks for work
+             * and waits again as needed.
+             * 
+             * @brief Blocks the parked thread until woken or the time passes.
+             * @param until Time at which to return, as from `scheduler_now`,
+             *      or a negative value to wait indefinitely.
+             */
+            virtual void wait(long long until) = 0;
+
+            /**
+             * @brief Wakes the parked thread from `wait`; called from any
+             *      thread.
+             */
+            virtual void wake() = 0;
+    };
+
     /**
      * Infinitely sits on a thread and executes a queue of tasks on that thread.
      * This allows multiple threads to queue tasks for execution on a collection
@@ -44,18 +145,58 @@ namespace lemon
     {
     private:
         /**
-         * Locally maintained queue of functions which should be executed.
-         * Execution is performed in a first-in first-out (FIFO) fashion. This
-         * queue implementation may not be thread-safe, so access should be
-         * synchronized by this worker thread container.
+         * Locally maintained queues of functions which should be executed, one
+         * per priority lane.  Execution within a lane is performed in a first-
+         * in first-out (FIFO) fashion. Any thread may add to these lock-free
+         * queues, but only the parked thread may poll from them.  Once full,
+         * tasks spill into the lane's overflow list (see `overflow`).
          * 
-         * The entirety of this queue will be executed upon an update cycle of
-         * the worker thread.  When this queue is empty, the worker thread has
+         * Every runnable task will be executed upon an update cycle of the
+         * worker thread.  When these queues are empty, the worker thread has
          * no tasks and will remain idle.
          * 
-         * @brief Task queue for this worker thread.
+         * @brief Task queues for this worker thread, indexed by priority.
+         */
+        mpsc_queue<timed_task, WORKER_QUEUE_CAPACITY> execution_queues[TASK_PRIORITIES];
+
+        /**
+         * Adding threads never wait for room in a lane: the only thread which
+         * can make room is the parked thread, which may be the adding thread
+         * itself or may be waiting on a lock which the adding thread holds.
+         * Once a lane has spilled, later tasks follow into the overflow until
+         * the parked thread has drained it, which keeps each adding thread's
+         * tasks in order; the parked thread drains the lock-free queue first.
+         * 
+         * @brief Unbounded, locked overflow of each lane's queue.
+         */
+        std::deque<timed_task> overflow[TASK_PRIORITIES];
+        std::mutex overflow_mutex;
+
+        /**
+         * @brief Number of tasks in each lane's overflow list.
+         */
+        std::atomic<size_t> overflowed[TASK_PRIORITIES] = { };
+
+        /**
+         * @brief Tasks run from higher lanes while each lane had work waiting.
          */
-        deque<std::function<void()>> execution_queue;
+        int skipped[TASK_PRIORITIES] = { };
+
+        /**
+         * @brief Per-frame execution time allowed for each lane in nanoseconds;
+         *      zero leaves the lane unlimited.
+         */
+        std::atomic<long long> budgets[TASK_PRIORITIES] = { };
+
+        /**
+         * @brief Execution time consumed by each lane since the last frame.
+         */
+        std::chrono::nanoseconds spent[TASK_PRIORITIES] = { };
+
+        /**
+         * @brief Profile scope names of tasks run from each lane.
+         */
+        const char* task_names[TASK_PRIORITIES] = { "Task (high)", "Task", "Task (low)" };
 
         /**
          * @brief Stores which thread on which this worker is operating.
@@ -73,15 +214,135 @@ namespace lemon
         bool is_parked = false;
 
         /**
-         * @brief Semaphore for adding and acquiring tasks in the queue.
+         * Set by the parked thread before it blocks on the wake signal.
+         * Adding threads only signal it if this flag was set, so
+         * tasks added while the worker is busy cost no wakeup at all.
+         * 
+         * @brief Whether the parked thread is (about to be) blocked.
+         */
+        std::atomic<bool> sleeping { false };
+
+        /**
+         * A condition variable rather than a semaphore, as its timed waits
+         * (used to wake for timers) are precise to the scheduler tick.
+         * 
+         * @brief Signal on which the parked thread blocks when idle.
+         */
+        std::condition_variable wake;
+        std::mutex wake_mutex;
+
+        /**
+         * @brief Set under the wake mutex when an adding thread wakes the
+         *      blocked parked thread.
+         */
+        bool woken = false;
+
+        /**
+         * @brief Replaces the wake signal when set; see `idle_waiter`.
+         */
+        std::atomic<idle_waiter*> waiter { nullptr };
+
+        /**
+         * @brief Configured upper bound of the idle spin, in nanoseconds.
+         */
+        std::atomic<long long> spin_limit { WORKER_SPIN_LIMIT_NS };
+
+        /**
+         * Grows towards twice the recently observed idle gaps which were
+         * shorter than the spin limit, and halves after each gap which was
+         * longer, so spinning only happens while it tends to pay off.
+         * 
+         * @brief Current adaptive length of the idle spin, in nanoseconds.
          */
-        std::counting_semaphore<512> semaphore { 0 };
+        long long spin_window = WORKER_SPIN_LIMIT_NS;
+
+        /**
+         * @brief Queue and execution telemetry of this worker thread.
+         */
+        scheduler_stats stats;
+
+        /**
+         * Delayed and periodic tasks are held here by the parked thread, which
+         * advances the wheel between tasks and bounds its idle wait by the
+         * next timer's deadline.
+         * 
+         * @brief Timers scheduled on this worker thread.
+         */
+        timer_wheel timers;
 
         /**
          * @brief A logger instance for log messages related to this class.
          */
         logger log { "Worker Thread" };
 
+        /**
+         * @brief Wakes the parked thread if it is blocked or about to block.
+         */
+        void _wake();
+
+        /**
+         * Spins for up to the adaptive spin window, then yields a few times,
+         * and only then blocks on the wake signal.  Tasks arriving while
+         * the thread spins or yields cost their producer no kernel wakeup.
+         * 
+         * @brief Waits on the parked thread until a task has been added.
+         */
+        void _wait();
+
+        /**
+         * @brief Blocks the parked thread until a task has been added.
+         * @param until Time at which to stop blocking, as from
+         *      `scheduler_now`, or a negative value to block indefinitely.
+         */
+        void _block(long long until);
+
+        /**
+         * @brief Runs a task on the parked thread, logging any error.
+         */
+        void _run(task& job);
+
+        /**
+         * @brief Hands a timer to the parked thread's timer wheel.
+         */
+        timer_handle _schedule_timer(std::chrono::nanoseconds delay, long long period, task job);
+
+        /**
+         * @brief Appends tasks to a lane's overflow list.
+         */
+        void _spill(int lane, timed_task&& next);
+        void _spill(int lane, task* tasks, size_t count);
+
+        /**
+         * @brief Polls the oldest task of a lane's overflow list.
+         */
+        bool _unspill(int lane, timed_task& next);
+
+        /**
+         * @brief Checks whether a lane has no published tasks.
+         */
+        bool _lane_empty(int lane);
+
+        /**
+         * @brief Checks whether a lane has work and budget left this frame.
+         */
+        bool _runnable(int lane);
+
+        /**
+         * @brief Checks whether any lane has runnable work.
+         */
+        bool _has_runnable();
+
+        /**
+         * Picks the highest runnable lane, unless a lower lane has been passed
+         * over `WORKER_STARVATION_LIMIT` times while waiting.
+         * 
+         * @brief Polls the next task to run from the parked thread.
+         * @param next Receives the polled task.
+         * @param lane Receives the lane the task was polled from.
+         * @return Whether a runnable task was found.
+         */
+        bool _poll_next(timed_task& next, int& lane);
+
     public:
         /**
          * Creates a new worker thread.  A worker thread can either park on an
@@ -110,10 +371,8 @@ namespace lemon
          * that each iteration over the queue leaves the queue empty.
          * 
          * When the queue is empty, this function will wait until a new task is
-         * added.  The thread will then unblock to execute the task.
-         * 
-         * The internal queue implementation may not be thread-safe, so access
-         * to it must be synchronized during adding and execution.
+         * added.  The thread will then unblock and execute every task which
+         * is ready before waiting again.
          * 
          * @brief Function which sits and waits on the worker thread.
          */
@@ -122,21 +381,255 @@ namespace lemon
         /**
          * Adds the provided function to the worker thread's execution queue.
          * The task will be executed at the next iteration over the task queue.
-         * Execution is performed in a first-in first-out (FIFO) fashion.
+         * Execution within a priority lane is performed in a first-in first-
+         * out (FIFO) fashion; tasks of different lanes may run out of order.
          * 
-         * The internal queue implementation may not be thread-safe, so access
-         * to it must be synchronized during adding and execution.
+         * This method is thread-safe and lock-free unless the queue is full.
          * 
          * @brief Enqueues the task to execute on this worker thread.
          * @param task Function containing the task to queue for execution.
+         * @param priority Lane in which the task is queued.
          */
-        void execute(std::function<void()> task);
+        void execute(task task, task_priority priority = task_priority::normal);
 
         /**
+         * A task queued from the parked thread itself runs immediately, within
+         * the task (and lane) which queued it.
+         * 
          * @brief Performs execution and hangs until the task is complete.
          * @param task Function containing the task to queue for execution.
+         * @param priority Lane in which the task is queued; a low-priority
+         *      wait may last until the lane's budget allows the task to run.
          */
-        void execute_wait(std::function<void()> task);
+        void execute_wait(task task, task_priority priority = task_priority::normal);
+
+        /**
+         * Moves each of the provided tasks into the execution queue in order,
+         * claiming queue space once and waking the parked thread at most once
+         * for the whole batch.  Tasks of a batch remain adjacent in the queue.
+         * 
+         * @brief Enqueues several tasks to execute on this worker thread.
+         * @param tasks Array of tasks to queue; each is left empty.
+         * @param count Number of tasks in the array.
+         * @param priority Lane in which the tasks are queued.
+         */
+        void execute_batch(task* tasks, size_t count, task_priority priority = task_priority::normal);
+
+        /**
+         * The task runs on the parked thread once the delay has passed, with
+         * a resolution of `TIMER_TICK_NS`.  No thread waits in the meantime.
+         * 
+         * @brief Enqueues a task to execute after a delay.
+         * @param delay Time to wait before running the task.
+         * @param job Task to run once.
+         * @return Handle which can cancel the task before it runs.
+         */
+        timer_handle execute_after(std::chrono::nanoseconds delay, task job);
+
+        /**
+         * The task first runs one period from now.  If the worker thread falls
+         * behind, missed runs are skipped rather than run in a burst.
+         * 
+         * @brief Enqueues a task to execute repeatedly at a fixed interval.
+         * @param period Positive interval between runs of the task.
+         * @param job Task to run each period.
+         * @return Handle which stops further runs of the task.
+         */
+        timer_handle execute_every(std::chrono::nanoseconds period, task job);
+
+        /**
+         * Limits how long tasks of a lane may run between two frame
+         * boundaries (see `begin_frame`).  Once a lane has used its budget,
+         * its remaining tasks wait for the next frame while other lanes keep
+         * running.  Tasks are not interrupted, so a single long task may still
+         * overrun the budget.
+         * 
+         * @brief Sets the per-frame execution budget of a priority lane.
+         * @param priority Lane to limit.
+         * @param budget Execution time per frame; zero removes the limit.
+         */
+        void set_budget(task_priority priority, std::chrono::nanoseconds budget);
+
+        /**
+         * Must be called from the parked thread (typically from a task), and
+         * the waiter must remain valid until it is replaced.
+         * 
+         * @brief Installs a library's event loop as this thread's idle wait.
+         * @param waiter Waiter to block in, or null for the default wait.
+         */
+        void set_idle_waiter(idle_waiter* waiter)
+        {
+            this->waiter.store(waiter);
+        }
+
+        /**
+         * Idle worker threads spin before blocking so that closely spaced
+         * tasks do not each cost a kernel wakeup.  The actual spin adapts to
+         * recent gaps between tasks, but never exceeds this limit.  Threads
+         * sharing processors with other busy threads should use a low limit.
+         * 
+         * @brief Sets the longest time this worker thread spins when idle.
+         * @param limit Spin limit; zero blocks immediately when idle.
+         */
+        void set_spin_limit(std::chrono::nanoseconds limit);
+
+        /**
+         * Must be called from the parked thread, typically from within the
+         * task which presents a frame.
+         * 
+         * @brief Marks a frame boundary, restoring each lane's budget.
+         */
+        void begin_frame();
+
+        /**
+         * @brief Summarizes this worker thread's activity since the previous
+         *      snapshot; see `scheduler_stats`.
+         * @param name Name of the worker thread to report.
+         */
+        scheduler_snapshot snapshot(std::string name)
+        {
+            return this->stats.snapshot(name);
+        }
+
+        /**
+         * Tasks are timed by the parked thread itself, so callers need not
+         * wrap tasks in profile scopes of their own.  Must be called before
+         * the first task is queued.
+         * 
+         * @brief Names the profile scope of every task this thread runs.
+         * @param name Scope name; must outlive this worker thread, as string
+         *      literals do.
+         */
+        void name_tasks(const char* name)
+        {
+            for (auto& lane_name : this->task_names)
+                lane_name = name;
+        }
+
+        /**
+         * @brief Checks whether the calling thread is the parked thread.
+         */
+        bool is_current()
+        {
+            return std::this_thread::get_id() == this->thread_id;
+        }
+
+        /**
+         * Restricts the parked thread to the provided logical processors.  The
+         * change is queued as a task, so it applies from the parked thread
+         * once earlier tasks have run.
+         * 
+         * @brief Pins this worker thread to a set of logical processors.
+         * @param cpus Indices of the logical processors to run on.
+         */
+        void pin(std::vector<int> cpus);
+
+        /**
+         * Enqueues the provided function like `execute`, but returns a future
+         * of its result rather than blocking like `execute_wait`.  Chain
+         * further work with `then` to avoid round-trips between threads.
+         * 
+         * @brief Enqueues the function and returns a future of its result.
+         * @param fn Function to execute on this worker thread.
+         * @return Future of the value returned by the function.
+         */
+        template <typename F>
+        auto execute_async(F&& fn) -> future<std::invoke_result_t<std::decay_t<F>&>>
+        {
+            promise<std::invoke_result_t<std::decay_t<F>&>> result;
+            auto value = result.get_future();
+
+            this->execute([fn = std::forward<F>(fn), result = std::move(result)]() mutable
+            {
+                result.fulfill(fn);
+            });
+
+            return value;
+        }
+
+        /**
+         * Awaited from a coroutine to continue its execution on this worker
+         * thread.  The coroutine is queued like any other task and does not
+         * occupy a thread while waiting; if it already runs on this worker
+         * thread, it continues without suspending.
+         * 
+         * When a lower priority is requested, the coroutine always suspends
+         * so its continuation is accounted to that lane.
+         * 
+         * @brief Creates an awaitable which resumes on this worker thread.
+         * @param priority Lane in which the coroutine is queued.
+         * @return Awaitable to `co_await` upon.
+         */
+        thread_awaiter schedule(task_priority priority = task_priority::normal)
+        {
+            return { *this, this->is_current() && priority != task_priority::low, priority };
+        }
+    };
+
+    /**
+     * Chunks are claimed with guided self-scheduling: each claim takes a share
+     * of the remaining indices proportional to the number of participants,
+     * but no fewer than the grain size.  Early chunks are large to keep
+     * overhead low, while later chunks shrink so participants finish at
+     * roughly the same time despite uneven per-index costs.
+     * 
+     * @brief Shared state of a range of indices processed in parallel.
+     * @author Zach Goethel
+     */
+    struct parallel_range
+    {
+        std::atomic<size_t> next;
+        size_t end;
+        size_t grain;
+        size_t participants;
+
+        /**
+         * @brief Number of helpers which may still be processing chunks.
+         */
+        std::atomic<int> active { 0 };
+
+        std::mutex error_mutex;
+        std::exception_ptr error;
+
+        parallel_range(size_t begin, size_t end, size_t grain, size_t participants)
+            : next(begin), end(end), grain(grain), participants(participants)
+        { }
+
+        /**
+         * @brief Claims the next chunk of indices to process.
+         * @param from Receives the first index of the claimed chunk.
+         * @param to Receives one past the last index of the claimed chunk.
+         * @return Whether a chunk was claimed; false once all are claimed.
+         */
+        bool claim(size_t& from, size_t& to)
+        {
+            auto start = next.load();
+
+            while (start < end)
+            {
+                auto remaining = end - start;
+                auto size = std::min(remaining, std::max(grain, remaining / (2 * participants)));
+
+                if (next.compare_exchange_weak(start, start + size))
+                {
+                    from = start;
+                    to = start + size;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        /**
+         * @brief Records the first error thrown by any participant.
+         */
+        void fail(std::exception_ptr ex)
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error)
+                error = ex;
+        }
     };
 
     /**
@@ -148,11 +641,14 @@ namespace lemon
      * The default number of threads is the hardware concurrency value, likely
      * the number of logical processors of the host system.
      * 
-     * The specific implementation of load-balancing is undefined, but expect a
-     * distribution of tasks to worker threads via a round-robbin selection or
-     * via finding the current shortest queue.  Once an adequate workload is
-     * assigned relatively evenly across worker threads, execution should remain
-     * faster than single-threading despite lackluster load-balancing.
+     * Load is balanced by work-stealing.  Each worker owns a local double-ended
+     * queue; tasks submitted from a pool worker are pushed onto that worker's
+     * own queue and popped back off in last-in first-out order, while tasks
+     * submitted from outside the pool are appended to a shared injector queue
+     * and taken in first-in first-out order.  A worker which runs out of local
+     * tasks first takes the oldest external task, and otherwise steals the
+     * oldest task from another worker's queue, so one long-running task does
+     * not hold up everything queued behind it while other workers sit idle.
      * 
      * @brief A collection of several load-balanced worker threads.
      * @author Zach Goethel
@@ -161,13 +657,43 @@ namespace lemon
     {
     private:
         /**
-         * A dynamically allocated array of dynamically allocated worker
-         * threads; this array must be properly allocated and deallocated upon
-         * startup and shutdown of the worker thread pool.
+         * A dynamically allocated array of local task queues, one per worker
+         * thread.  Only the owning worker adds to its queue, pushing and
+         * polling the front, so the back always holds the oldest task, which
+         * is where other workers steal from.
+         * 
+         * @brief A dynamically allocated array of per-worker task queues.
+         */
+        deque<timed_task>* queues;
+
+        /**
+         * Tasks submitted from outside the pool are added to the back and
+         * taken from the front by whichever worker is idle first, so external
+         * tasks start in the order in which they were submitted.
+         * 
+         * @brief Queue of tasks submitted from outside the pool.
+         */
+        deque<timed_task> injector;
+
+        /**
+         * @brief Queue depth of the injector; wait and run times of its tasks
+         *      are reported against the workers which ran them.
+         */
+        scheduler_stats injector_stats;
+
+        /**
+         * Queue depth is reported against the queue a task was added to, while
+         * wait and run times are reported against the worker which executed
+         * the task, whether or not it was stolen.
          * 
-         * @brief A dynamically allocated array of pointers to worker threads.
+         * @brief A dynamically allocated array of per-worker telemetry.
          */
-        worker_thread** workers;
+        scheduler_stats* stats;
+
+        /**
+         * @brief A dynamically allocated array of the pool's running threads.
+         */
+        std::thread* threads;
 
         /**
          * This value specifies the number of threads which were created and
@@ -183,15 +709,108 @@ namespace lemon
         int num_workers;
 
         /**
-         * @brief Atomic counter for round-robin load balancing across workers.
+         * Released once for each task added to any of the worker queues.  A
+         * worker which acquires the semaphore is guaranteed that at least one
+         * unclaimed task exists in some queue of the pool.
+         * 
+         * @brief Semaphore counting tasks pending across all worker queues.
          */
-        std::atomic<int> round_robin;
+        std::counting_semaphore<> pending { 0 };
+
+        /**
+         * @brief Cleared upon destruction to signal workers to terminate.
+         */
+        std::atomic<bool> running { true };
 
         /**
          * @brief A logger instance for log messages related to this class.
          */
         logger log { "Worker Pool" };
 
+        /**
+         * Takes the next task for the provided worker, first from the front of
+         * its own queue, then from the front of the injector, and then from
+         * the back of each other worker's queue.
+         * Should only be called once a pending task has been acquired.
+         * 
+         * @brief Finds the next task to execute on the provided worker.
+         * @param index Index of the worker thread looking for a task.
+         * @return The task which was claimed by the worker thread.
+         */
+        timed_task _take(int index);
+
+        /**
+         * @brief Loop which executes tasks on a single thread of the pool.
+         * @param index Index of the worker thread in this pool.
+         */
+        void _work(int index);
+
+        /**
+         * Helper tasks are queued to the pool while the calling thread also
+         * processes chunks.  Once the range is exhausted, the caller waits only
+         * for helpers which are still processing a chunk; helpers which start
+         * afterwards find no work and never touch the participant function.
+         * 
+         * @brief Runs the participant function on the caller and the pool.
+         * @param begin First index of the range.
+         * @param end One past the last index of the range.
+         * @param grain Minimum chunk size, or zero to choose automatically.
+         * @param participant Function which claims and processes chunks of
+         *      the provided range until none remain.
+         */
+        template <typename P>
+        void _parallel(size_t begin, size_t end, size_t grain, P& participant)
+        {
+            if (begin >= end)
+                return;
+
+            auto count = end - begin;
+            size_t participants = this->num_workers + 1;
+            // Default to a grain yielding a few dozen chunks per participant
+            if (grain == 0)
+                grain = std::max((size_t)1, count / (participants * 32));
+
+            auto range = std::make_shared<parallel_range>(begin, end, grain, participants);
+
+            // Small ranges are not worth waking other workers for
+            auto chunks = count / grain;
+            auto helpers = std::min((size_t)this->num_workers, chunks > 1 ? chunks - 1 : 0);
+            for (size_t i = 0; i < helpers; i++)
+                this->execute([range, participant = &participant]()
+                {
+                    range->active++;
+
+                    if (range->next.load() < range->end)
+                        try
+                        {
+                            (*participant)(*range);
+                        } catch(...)
+                        {
+                            range->fail(std::current_exception());
+                        }
+
+                    if (range->active.fetch_sub(1) == 1)
+                        range->active.notify_all();
+                });
+
+            try
+            {
+                participant(*range);
+            } catch(...)
+            {
+                range->fail(std::current_exception());
+                // Claim the remainder so helpers wind down
+                range->next = range->end;
+            }
+
+            // Latch until every helper which claimed work has finished
+            for (int active; (active = range->active.load()) != 0; )
+                range->active.wait(active);
+
+            if (range->error)
+                std::rethrow_exception(range->error);
+        }
+
     public:
         /**
          * Upon construction of a worker thread pool, several worker threads
@@ -202,11 +821,17 @@ namespace lemon
          * The constructor will block until all threads are successfully
          * started, and tasks can be assigned immediately following construction.
          * 
+         * The host's processor topology and the placement of each worker are
+         * logged upon startup.
+         * 
          * @brief Constructs and starts a new pool of worker threads.
          * @param num_workers The number of threads to start and assign to this
          *      pool, which defaults to the system's number of logical cores.
+         * @param placement Policy binding workers to logical processors; by
+         *      default, workers are not pinned.
          */
-        worker_pool(int num_workers = std::thread::hardware_concurrency());
+        worker_pool(int num_workers = std::thread::hardware_concurrency(),
+            worker_placement placement = { });
 
         /**
          * This destructor will cause worker threads to cease executing and
@@ -220,19 +845,164 @@ namespace lemon
         ~worker_pool();
 
         /**
-         * Adds the provided function to a selected worker thread's execution
-         * queue.  The exact implementation of the worker selection (load-
-         * balancing) is undefined and subject to change, but expect a round-
-         * robin or "shortest queue" selection of a worker thread to perform
-         * the provided task.
+         * Adds the provided function to a worker thread's execution queue.
+         * Tasks submitted from one of this pool's workers are kept on that
+         * worker's queue; other tasks are queued on the pool's injector, from
+         * which idle workers take them in submission order.  Idle workers
+         * will also steal queued tasks from busy workers.
          * 
          * There is no guarantee of execution order for tasks provided to this
-         * method.  No two sequential tasks may necessarily be assigned to the 
-         * same worker's queue, thus execution order is unpredictable.
+         * method.  Tasks are started by whichever worker takes them first,
+         * thus execution order is unpredictable.
          * 
          * @brief Enqueues the task to execute on a worker thread.
          * @param task Function containing the task to queue for execution.
          */
-        void execute(std::function<void()> task);
+        void execute(task task);
+
+        /**
+         * Tasks submitted from one of this pool's workers are kept on that
+         * worker's queue; otherwise the batch is added to the injector.
+         * Either way the queue is locked once, and idle workers steal from
+         * the batch.
+         * 
+         * @brief Enqueues several tasks to execute on worker threads.
+         * @param tasks Array of tasks to queue; each is left empty.
+         * @param count Number of tasks in the array.
+         */
+        void execute_batch(task* tasks, size_t count);
+
+        /**
+         * Comparing worker rates exposes uneven distribution of work across
+         * the pool.
+         * 
+         * @brief Summarizes each worker's activity since the previous snapshot.
+         * @return One snapshot per worker thread, in order, followed by one
+         *      of the injector queue of external submissions.
+         */
+        std::vector<scheduler_snapshot> snapshot();
+
+        /**
+         * Pool timers are kept by a single timer thread shared by all pools,
+         * which submits each due task to the pool.  Timers must be cancelled
+         * before the pool is destroyed.
+         * 
+         * @brief Enqueues a task on the pool after a delay.
+         * @param delay Time to wait before submitting the task.
+         * @param job Task to run once.
+         * @return Handle which can cancel the task before it is submitted.
+         */
+        timer_handle execute_after(std::chrono::nanoseconds delay, task job);
+
+        /**
+         * Each period submits a new run of the task to the pool, so runs may
+         * overlap if the task takes longer than its period.
+         * 
+         * @brief Enqueues a task on the pool repeatedly at a fixed interval.
+         * @param period Positive interval between runs of the task.
+         * @param job Task to run each period.
+         * @return Handle which stops further runs of the task.
+         */
+        timer_handle execute_every(std::chrono::nanoseconds period, task job);
+
+        /**
+         * @brief Enqueues the function on a worker and returns a future of its
+         *      result.
+         * @param fn Function to execute on a worker thread of this pool.
+         * @return Future of the value returned by the function.
+         */
+        template <typename F>
+        auto execute_async(F&& fn) -> future<std::invoke_result_t<std::decay_t<F>&>>
+        {
+            promise<std::invoke_result_t<std::decay_t<F>&>> result;
+            auto value = result.get_future();
+
+            this->execute([fn = std::forward<F>(fn), result = std::move(result)]() mutable
+            {
+                result.fulfill(fn);
+            });
+
+            return value;
+        }
+
+        /**
+         * @brief Creates an awaitable which resumes a coroutine on a worker
+         *      thread of this pool.
+         * @return Awaitable to `co_await` upon.
+         */
+        schedule_awaiter<worker_pool> schedule()
+        {
+            return { *this };
+        }
+
+        /**
+         * Invokes the function once for every index in the range, spreading
+         * chunks of indices across the pool.  The calling thread processes
+         * chunks alongside the workers rather than sitting blocked, so it is
+         * safe to call from within a task running on this pool.  The call
+         * returns once every index has been processed; the first exception
+         * thrown by the function is rethrown to the caller.
+         * 
+         * @brief Processes a range of indices in parallel across the pool.
+         * @param begin First index of the range.
+         * @param end One past the last index of the range.
+         * @param fn Function invoked with each index of the range.
+         * @param grain Minimum number of indices per chunk, or zero to choose
+         *      based on the size of the range and the pool.
+         */
+        template <typename F>
+        void parallel_for(size_t begin, size_t end, F&& fn, size_t grain = 0)
+        {
+            auto participant = [&fn](parallel_range& range)
+            {
+                size_t from, to;
+                while (range.claim(from, to))
+                    for (auto i = from; i < to; i++)
+                        fn(i);
+            };
+
+            this->_parallel(begin, end, grain, participant);
+        }
+
+        /**
+         * Accumulates over a range of indices in parallel.  Each participant
+         * folds its chunks into a local accumulator starting from the identity
+         * value, and the local results are then combined with the reduction
+         * function.  The order of combination is unspecified, so the reduction
+         * should be associative and commutative.
+         * 
+         * @brief Reduces a range of indices in parallel across the pool.
+         * @param begin First index of the range.
+         * @param end One past the last index of the range.
+         * @param identity Initial value of each accumulator.
+         * @param fn Function invoked with an accumulator and each index.
+         * @param reduce Function combining two accumulators into one.
+         * @param grain Minimum number of indices per chunk, or zero to choose
+         *      based on the size of the range and the pool.
+         * @return The combined value of all accumulators.
+         */
+        template <typename T, typename F, typename R>
+        T parallel_reduce(size_t begin, size_t end, T identity, F&& fn, R&& reduce, size_t grain = 0)
+        {
+            T result = identity;
+            std::mutex result_mutex;
+
+            auto participant = [&](parallel_range& range)
+            {
+                T local = identity;
+
+                size_t from, to;
+                while (range.claim(from, to))
+                    for (auto i = from; i < to; i++)
+                        fn(local, i);
+
+                std::lock_guard<std::mutex> lock(result_mutex);
+                result = reduce(std::move(result), std::move(local));
+            };
+
+            this->_parallel(begin, end, grain, participant);
+
+            return result;
+        }
     };
 }
\ No newline at end of file
@@ -15,10 +15,83 @@ namespace lemon
     // Initialize static context counter
     std::atomic<int> glfw_context::context_count(0);
 
-    glfw_context::glfw_context() : context()
+    // Event loop in which the main thread waits while GLFW is initialized
+    glfw_waiter glfw_pump;
+
+    void glfw_waiter::wait(long long until)
+    {
+        if (until < 0)
+        {
+            glfwWaitEvents();
+            return;
+        }
+
+        auto seconds = (until - scheduler_now()) / 1000000000.0;
+        if (seconds > 0.0)
+            glfwWaitEventsTimeout(seconds);
+        else
+            glfwPollEvents();
+    }
+
+    void glfw_waiter::wake()
+    {
+        // Thread-safe; interrupts a wait on the main thread
+        glfwPostEmptyEvent();
+    }
+
+    /**
+     * @brief Buffers an event for the input of the provided window.
+     */
+    void _glfw_push(GLFWwindow* window, input_event event)
     {
-        static worker_thread polling(true);
+        event.time = scheduler_now();
+        static_cast<glfw_input*>(glfwGetWindowUserPointer(window))->push(event);
+    }
+
+    void _glfw_key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+    {
+        _glfw_push(window, { .type = input_type::key, .code = key, .action = action, .mods = mods });
+    }
 
+    void _glfw_button_callback(GLFWwindow* window, int button, int action, int mods)
+    {
+        _glfw_push(window, { .type = input_type::mouse_button, .code = button, .action = action, .mods = mods });
+    }
+
+    void _glfw_cursor_callback(GLFWwindow* window, double x, double y)
+    {
+        _glfw_push(window, { .type = input_type::cursor, .x = x, .y = y });
+    }
+
+    void _glfw_size_callback(GLFWwindow* window, int width, int height)
+    {
+        _glfw_push(window, { .type = input_type::resize, .x = (double)width, .y = (double)height });
+    }
+
+    void _glfw_close_callback(GLFWwindow* window)
+    {
+        _glfw_push(window, { .type = input_type::close });
+    }
+
+    void glfw_input::attach(GLFWwindow* window)
+    {
+        glfwSetWindowUserPointer(window, this);
+
+        glfwSetKeyCallback(window, _glfw_key_callback);
+        glfwSetMouseButtonCallback(window, _glfw_button_callback);
+        glfwSetCursorPosCallback(window, _glfw_cursor_callback);
+        glfwSetWindowSizeCallback(window, _glfw_size_callback);
+        glfwSetWindowCloseCallback(window, _glfw_close_callback);
+    }
+
+    void glfw_input::push(input_event event)
+    {
+        if (!this->events.try_add(std::move(event)))
+            this->dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    glfw_context::glfw_context() : context()
+    {
         // GLFW operations must be executed on the main thread
         // Operation will hang until executed
         main_thread.execute_wait([&]()
@@ -32,14 +105,8 @@ namespace lemon
                 
                 this->log.info("Initialized global GLFW context");
 
-                polling.execute([&]()
-                {
-                    while (context_count > 0)
-                    {
-                        main_thread.execute_wait(::glfwPollEvents);
-                        std::this_thread::sleep_for(std::chrono::milliseconds(2));
-                    }
-                });
+                // Wait for window events whenever the main thread is idle
+                main_thread.set_idle_waiter(&glfw_pump);
             }
         });
     }
@@ -54,6 +121,7 @@ namespace lemon
             if (glfw_context::context_count.fetch_sub(1) == 1)
             {
                 this->log.info("Terminating global GLFW context");
+                main_thread.set_idle_waiter(nullptr);
 
                 // Terminate the GLFW library
                 glfwTerminate();
@@ -7,6 +7,11 @@
 #include "core/context.h"
 #include "core/logger.h"
 #include "core/bootstrap.h"
+#include "core/input.h"
+#include "core/mpsc_queue.h"
+
+// Window and input events buffered per window between frames
+#define GLFW_INPUT_CAPACITY 1024
 
 ////////////////////////////////////////////////////////////////////////////////
 //                          Lemon 3D Graphics Engine                          //
@@ -20,6 +25,72 @@
 
 namespace lemon
 {
+    /**
+     * Installed on the main thread while GLFW is initialized, so that the
+     * main thread sleeps in GLFW's event loop and processes window events as
+     * they arrive.  Queued tasks and timers wake it with an empty event.
+     * 
+     * @brief Idle wait of the main thread through GLFW's event loop.
+     * @author Zach Goethel
+     */
+    class glfw_waiter : public idle_waiter
+    {
+        public:
+            void wait(long long until);
+
+            void wake();
+    };
+
+    /**
+     * Callbacks of the attached window run on the main thread and add each
+     * event to a lock-free ring, which the application thread drains once per
+     * frame.  If the application falls more than a ring's worth of events
+     * behind, further events are dropped and counted rather than blocking the
+     * main thread.
+     * 
+     * @brief Lock-free buffer of a GLFW window's input events.
+     * @author Zach Goethel
+     */
+    class glfw_input
+    {
+        private:
+            mpsc_queue<input_event, GLFW_INPUT_CAPACITY> events;
+
+            std::atomic<uint64_t> dropped { 0 };
+
+        public:
+            /**
+             * @brief Installs input callbacks on a window; must be called on
+             *      the main thread.
+             * @param window Window whose events are buffered.
+             */
+            void attach(GLFWwindow* window);
+
+            /**
+             * @brief Buffers an event from a window callback.
+             */
+            void push(input_event event);
+
+            /**
+             * @brief Removes the oldest buffered event; only one thread may
+             *      poll events.
+             * @param event Receives the removed event.
+             * @return Whether an event was available.
+             */
+            bool poll(input_event& event)
+            {
+                return this->events.try_poll(event);
+            }
+
+            /**
+             * @brief Number of events dropped because the ring was full.
+             */
+            uint64_t dropped_events()
+            {
+                return this->dropped.load();
+            }
+    };
+
     /**
      * @brief GLFW windowing context extension implementation.
      * @author Zach Goethel
@@ -0,0 +1,49 @@
+#include "gl_commands.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace lemon
+{
+    void gl_command_buffer::replay(gl_state& state) const
+    {
+        for (auto& command : this->commands)
+            switch (command.type)
+            {
+            case gl_command_type::viewport:
+                state.viewport(command.viewport.x, command.viewport.y, command.viewport.width, command.viewport.height);
+                break;
+            case gl_command_type::clear_color:
+                state.clear_color(command.color.red, command.color.green, command.color.blue, command.color.alpha);
+                break;
+            case gl_command_type::enable:
+                state.enable(command.capability);
+                break;
+            case gl_command_type::disable:
+                state.disable(command.capability);
+                break;
+            case gl_command_type::clear:
+                glClear(command.mask);
+                break;
+            case gl_command_type::use_program:
+                state.use_program(command.program);
+                break;
+            case gl_command_type::uniform_1f:
+                glUniform1f(glGetUniformLocation(command.uniform.program, command.uniform.name), command.uniform.value);
+                break;
+            case gl_command_type::bind_buffer_base:
+                state.bind_buffer_base(command.binding.target, command.binding.index, *command.binding.buffer);
+                break;
+            case gl_command_type::draw_arrays:
+                glDrawArrays(command.draw.mode, command.draw.first, command.draw.count);
+                break;
+            }
+    }
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "GL/glew.h"
+
+#include "gl_state.h"
+
+// Commands reserved by a new command buffer; buffers are recycled, so this
+// only bounds reallocation during the first frames
+#ifndef GL_COMMAND_BUFFER_RESERVE
+    #define GL_COMMAND_BUFFER_RESERVE 1024
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace lemon
+{
+    /**
+     * @brief Kind of a recorded OpenGL command.
+     */
+    enum class gl_command_type : uint8_t
+    {
+        viewport,
+        clear_color,
+        enable,
+        disable,
+        clear,
+        use_program,
+        uniform_1f,
+        bind_buffer_base,
+        draw_arrays
+    };
+
+    /**
+     * Commands are plain values of a fixed size, so recording one copies a few
+     * words into its buffer without capturing or allocating anything.
+     *
+     * @brief A single recorded OpenGL command and its arguments.
+     */
+    struct gl_command
+    {
+        gl_command_type type;
+
+        union
+        {
+            struct { GLint x, y; GLsizei width, height; } viewport;
+            struct { GLfloat red, green, blue, alpha; } color;
+            GLenum capability;
+            GLbitfield mask;
+            GLuint program;
+            struct { GLuint program; const char* name; GLfloat value; } uniform;
+            /**
+             * Buffer names are generated on the context thread, so the name
+             * is read when the command is replayed rather than recorded.  The
+             * name's owner is kept alive by the command buffer.
+             */
+            struct { GLenum target; GLuint index; const GLuint* buffer; } binding;
+            struct { GLenum mode; GLint first; GLsizei count; } draw;
+        };
+    };
+
+    /**
+     * Any thread may record commands into a buffer which it owns; the buffer is
+     * then submitted to its context as a whole (see `gl_context::submit`) and
+     * replayed on the context thread in a single task.  Compared to performing
+     * each call as its own task, this queues one task per frame instead of one
+     * per draw, and keeps the commands contiguous in memory.
+     *
+     * Buffers keep their capacity when reset, and contexts recycle submitted
+     * buffers, so that recording a frame does not allocate once warmed up.
+     * 
+     * Resources referenced by recorded commands are kept alive until the
+     * buffer is reset after its replay, so a resource may be released while
+     * commands using it are still queued.
+     *
+     * @brief Linear list of recorded OpenGL commands.
+     * @author Zach Goethel
+     */
+    class gl_command_buffer
+    {
+        private:
+            std::vector<gl_command> commands;
+
+            /**
+             * @brief Owners of data referenced by recorded commands, released
+             *      when the buffer is reset.
+             */
+            std::vector<std::shared_ptr<const void>> owners;
+
+            /**
+             * @brief Appends a command of the provided type.
+             */
+            gl_command& _push(gl_command_type type)
+            {
+                auto& command = this->commands.emplace_back();
+                command.type = type;
+
+                return command;
+            }
+
+        public:
+            gl_command_buffer()
+            {
+                this->commands.reserve(GL_COMMAND_BUFFER_RESERVE);
+                this->owners.reserve(GL_COMMAND_BUFFER_RESERVE);
+            }
+
+            void viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+            {
+                this->_push(gl_command_type::viewport).viewport = { x, y, width, height };
+            }
+
+            void clear_color(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+            {
+                this->_push(gl_command_type::clear_color).color = { red, green, blue, alpha };
+            }
+
+            void enable(GLenum capability)
+            {
+                this->_push(gl_command_type::enable).capability = capability;
+            }
+
+            void disable(GLenum capability)
+            {
+                this->_push(gl_command_type::disable).capability = capability;
+            }
+
+            void clear(GLbitfield mask)
+            {
+                this->_push(gl_command_type::clear).mask = mask;
+            }
+
+            void use_program(GLuint program)
+            {
+                this->_push(gl_command_type::use_program).program = program;
+            }
+
+            /**
+             * @brief Sets a float uniform of a program, which is looked up by
+             *      name when replayed.
+             * @param name Name of the uniform; must outlive the buffer's
+             *      replay, as string literals do.
+             */
+            void uniform(GLuint program, const char* name, GLfloat value)
+            {
+                this->_push(gl_command_type::uniform_1f).uniform = { program, name, value };
+            }
+
+            /**
+             * @brief Binds a buffer to an indexed binding point.
+             * @param buffer Name of the buffer, sharing ownership with the
+             *      resource which holds it; kept alive until the next reset.
+             */
+            void bind_buffer_base(GLenum target, GLuint index, std::shared_ptr<const GLuint> buffer)
+            {
+                this->_push(gl_command_type::bind_buffer_base).binding = { target, index, buffer.get() };
+
+                // Consecutive bindings often share an owner
+                if (this->owners.empty() || this->owners.back() != buffer)
+                    this->owners.push_back(std::move(buffer));
+            }
+
+            void draw_arrays(GLenum mode, GLint first, GLsizei count)
+            {
+                this->_push(gl_command_type::draw_arrays).draw = { mode, first, count };
+            }
+
+            /**
+             * @brief Number of commands recorded since the last reset.
+             */
+            size_t size() const
+            {
+                return this->commands.size();
+            }
+
+            bool empty() const
+            {
+                return this->commands.empty();
+            }
+
+            /**
+             * @brief Discards recorded commands, keeping the buffer's capacity,
+             *      and releases resources which they referenced.
+             */
+            void reset()
+            {
+                this->commands.clear();
+                this->owners.clear();
+            }
+
+            /**
+             * @brief Issues the recorded commands in order; must be called on
+             *      the context thread of the context they were recorded for.
+             * @param state State cache of the context, through which state
+             *      changes are issued.
+             */
+            void replay(gl_state& state) const;
+    };
+}
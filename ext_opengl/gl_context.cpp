@@ -1,5 +1,7 @@
 #include "gl_context.h"
 
+#include "core/profiler.h"
+
 ////////////////////////////////////////////////////////////////////////////////
 //                          Lemon 3D Graphics Engine                          //
 //                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
@@ -15,8 +17,26 @@ namespace lemon
     void GLAPIENTRY _gl_message_callback(GLenum source, GLenum type, GLuint id, GLenum severity,
                     GLsizei length, const GLchar* message, const void* userParam )
     {
-        std::lock_guard<std::mutex> lock(_log_mutex());
-        std::cerr << message << std::endl;
+        // Drivers may repeat a message per draw call; limit each message id
+        static logger log = []()
+        {
+            logger log("OpenGL Debug");
+            log.limit(GL_DEBUG_RATE_LIMIT, GL_DEBUG_MESSAGE_LIMIT);
+
+            return log;
+        }();
+
+        auto level = log_level::debug;
+        if (severity == GL_DEBUG_SEVERITY_HIGH)
+            level = log_level::error;
+        else if (severity == GL_DEBUG_SEVERITY_MEDIUM)
+            level = log_level::warn;
+
+        // Route driver messages through the logger, so that they are queued
+        // rather than written from the render thread; suppressed messages are
+        // never copied
+        auto key = ((uint64_t)source << 48) ^ ((uint64_t)type << 32) ^ id;
+        log.log(level, key, std::string_view(message, length));
     }
 
     gl_context::gl_context(
@@ -25,12 +45,7 @@ namespace lemon
         bool forward_compat
     ) : context()
     {
-        log.info("Creating a new OpenGL context and pipelines ("
-            + std::to_string(major)
-            + "."
-            + std::to_string(minor)
-            + (core ? " core" : "")
-            + ")");
+        log.info("Creating a new OpenGL context and pipelines ({}.{}{})", major, minor, core ? " core" : "");
 
         // GLFW window must be created on main thread
         main_thread.execute_wait([&]()
@@ -51,6 +66,8 @@ namespace lemon
             // Create new window handle and make current
             this->window_handle = glfwCreateWindow(1400, 900, "Lemon", NULL, NULL);
             glfwMakeContextCurrent(this->window_handle);
+            // Buffer window events for the application thread
+            this->input.attach(this->window_handle);
 
             // Initialize GLEW context bindings
             if (glewInit() != GLEW_OK)
@@ -68,18 +85,45 @@ namespace lemon
 
         // Make this context current in the dedicated worker thread
         auto window_handle = this->window_handle;
-        this->perform([=]()
+        this->perform([=, this]()
         {
             glfwMakeContextCurrent(window_handle);
 
-            glEnable(GL_DEBUG_OUTPUT);
+            this->state_cache.enable(GL_DEBUG_OUTPUT);
             glDebugMessageCallback(_gl_message_callback, 0);
         });
+
+        this->set_debug_severity(GL_DEBUG_MIN_SEVERITY);
+    }
+
+    void gl_context::set_debug_severity(GLenum minimum)
+    {
+        this->perform([=]()
+        {
+            GLenum severities[] =
+            {
+                GL_DEBUG_SEVERITY_NOTIFICATION,
+                GL_DEBUG_SEVERITY_LOW,
+                GL_DEBUG_SEVERITY_MEDIUM,
+                GL_DEBUG_SEVERITY_HIGH
+            };
+
+            // Enable the minimum severity and each more severe one
+            bool enabled = false;
+            for (auto severity : severities)
+            {
+                enabled = enabled || severity == minimum;
+                glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, severity, 0, nullptr,
+                    enabled ? GL_TRUE : GL_FALSE);
+            }
+        });
     }
 
     gl_context::~gl_context()
     {
         log.info("Destroying OpenGL context and related resources");
+        // Frames in flight still present to the window
+        this->wait_frames();
 
         // GLFW windows must be destroyed on the main thread
         auto window_handle = this->window_handle;
@@ -91,16 +135,78 @@ namespace lemon
 
     void gl_context::update()
     {
-        this->perform([&]()
+        // Build the next frame while the context thread presents this one
+        this->submit_frame([this]()
         {
             glFlush();
 
-            this->should_close |= (bool)glfwWindowShouldClose(this->window_handle);
+            if (glfwWindowShouldClose(this->window_handle))
+                this->should_close = true;
             glfwSwapInterval(true);
-            glfwSwapBuffers(this->window_handle);
+            {
+                LEMON_PROFILE_SCOPE("Swap buffers");
+                glfwSwapBuffers(this->window_handle);
+            }
 
             glClear(GL_COLOR_BUFFER_BIT);
-        }, true);
+            // Publish the frame's state cache counters
+            auto counters = this->state_cache.take_counters();
+            this->frame_issued.store(counters.issued);
+            this->frame_filtered.store(counters.filtered);
+            // Budgeted lanes may run again in the next frame
+            this->begin_frame();
+        });
+    }
+
+    std::unique_ptr<gl_command_buffer> gl_context::record()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->commands_mutex);
+            if (!this->free_commands.empty())
+            {
+                auto commands = std::move(this->free_commands.back());
+                this->free_commands.pop_back();
+
+                return commands;
+            }
+        }
+
+        return std::make_unique<gl_command_buffer>();
+    }
+
+    void gl_context::submit(std::unique_ptr<gl_command_buffer> commands)
+    {
+        this->perform([this, commands = std::move(commands)]() mutable
+        {
+            commands->replay(this->state_cache);
+            commands->reset();
+
+            // Recycle the buffer for a later frame
+            std::lock_guard<std::mutex> lock(this->commands_mutex);
+            this->free_commands.push_back(std::move(commands));
+        });
+    }
+
+    void gl_context::submit(std::vector<std::unique_ptr<gl_command_buffer>> lists)
+    {
+        this->perform([this, lists = std::move(lists)]() mutable
+        {
+            for (auto& commands : lists)
+            {
+                commands->replay(this->state_cache);
+                commands->reset();
+            }
+
+            // Recycle the buffers for a later frame
+            std::lock_guard<std::mutex> lock(this->commands_mutex);
+            for (auto& commands : lists)
+                this->free_commands.push_back(std::move(commands));
+        });
+    }
+
+    bool gl_context::poll_input(input_event& event)
+    {
+        return this->input.poll(event);
     }
 
     bool gl_context::is_alive()
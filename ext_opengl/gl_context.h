@@ -7,6 +7,17 @@
 
 #include "core/context.h"
 
+#include "gl_commands.h"
+
+// Least severe driver debug message reported; lower severities are disabled
+// in the driver, so they are never generated
+#ifndef GL_DEBUG_MIN_SEVERITY
+    #define GL_DEBUG_MIN_SEVERITY GL_DEBUG_SEVERITY_LOW
+#endif
+// Driver debug messages logged per second in total, and with the same id
+#define GL_DEBUG_RATE_LIMIT 100
+#define GL_DEBUG_MESSAGE_LIMIT 5
+
 ////////////////////////////////////////////////////////////////////////////////
 //                          Lemon 3D Graphics Engine                          //
 //                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
@@ -35,15 +46,40 @@ namespace lemon
          */
         GLFWwindow* window_handle = nullptr;
 
+        /**
+         * @brief Window and input events of the window awaiting the next frame.
+         */
+        glfw_input input;
+
         /**
          * @brief OpenGL-context-specific logger instance.
          */
         logger log { "OpenGL" };
 
         /**
-         * @brief A static flag of whether this context should close.
+         * @brief A flag of whether this context should close; set from the
+         *      context thread as frames are presented.
+         */
+        std::atomic<bool> should_close { false };
+
+        /**
+         * @brief Replayed command buffers kept for reuse, so that recording
+         *      frames stops allocating once warmed up.
+         */
+        std::mutex commands_mutex;
+        std::vector<std::unique_ptr<gl_command_buffer>> free_commands;
+
+        /**
+         * @brief Shadow of this context's state, used on the context thread.
+         */
+        gl_state state_cache;
+
+        /**
+         * @brief State-changing calls issued and filtered during the most
+         *      recently presented frame.
          */
-        bool should_close = false;
+        std::atomic<uint64_t> frame_issued { 0 };
+        std::atomic<uint64_t> frame_filtered { 0 };
     
     public:
         /**
@@ -66,6 +102,67 @@ namespace lemon
          */
         void update();
 
+        /**
+         * @brief Provides an empty command buffer to record on any thread,
+         *      reusing a previously submitted buffer where possible.
+         */
+        std::unique_ptr<gl_command_buffer> record();
+
+        /**
+         * Commands are replayed in order within a single task on the context
+         * thread, after which the buffer is kept for reuse by `record`.
+         *
+         * @brief Submits recorded commands for execution in this context.
+         * @param commands Buffer of commands recorded for this context.
+         */
+        void submit(std::unique_ptr<gl_command_buffer> commands);
+
+        /**
+         * Lists may be recorded concurrently, such as by the workers of a
+         * pool, each into its own buffer.  Handing the buffers over seals
+         * them, and they are replayed back to back within a single task, in
+         * the order of the provided vector rather than the order in which
+         * they were recorded, so the submitted frame is deterministic.
+         *
+         * @brief Submits several command lists for execution in order.
+         * @param lists Buffers of commands recorded for this context.
+         */
+        void submit(std::vector<std::unique_ptr<gl_command_buffer>> lists);
+
+        /**
+         * Bindings, the program, the vertex array, viewport, clear color and
+         * enabled capabilities should be set through the cache, so that
+         * redundant calls never reach the driver.
+         *
+         * @brief Cache of this context's state; only to be used on the
+         *      context thread.
+         */
+        gl_state& state()
+        {
+            return this->state_cache;
+        }
+
+        /**
+         * @brief Counts state-changing calls which were issued to the driver
+         *      and filtered by the state cache during the last presented frame.
+         */
+        gl_state_counters state_counters()
+        {
+            return { this->frame_issued.load(), this->frame_filtered.load() };
+        }
+
+        /**
+         * @brief Sets the least severe driver debug message which is reported,
+         *      disabling less severe messages within the driver.
+         * @param minimum One of the `GL_DEBUG_SEVERITY_*` values.
+         */
+        void set_debug_severity(GLenum minimum);
+
+        /**
+         * @brief Removes the oldest buffered window or input event.
+         */
+        bool poll_input(input_event& event);
+
         /**
          * @brief Checks whether this context is currently alive.
          * 
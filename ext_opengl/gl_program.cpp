@@ -16,7 +16,9 @@ namespace lemon
         std::string src_vert,
         std::string src_frag) : shader_program(in_context)
     {
-        in_context->perform([&]()
+        // Compilation is queued without waiting; later operations on this
+        // program are queued behind it on the context thread
+        in_context->perform([this, src_vert = std::move(src_vert), src_frag = std::move(src_frag)]()
         {
             this->pointer = glCreateProgram();
 
@@ -25,7 +27,7 @@ namespace lemon
             
             this->_link();
             this->_use();
-        }, true);
+        });
     }
 
     gl_program::~gl_program()
@@ -33,6 +35,7 @@ namespace lemon
         in_context->perform([&]()
         {
             glDeleteProgram(this->pointer);
+            static_cast<gl_context*>(this->in_context.get())->state().forget_program(this->pointer);
         }, true);
     }
 
@@ -56,7 +59,7 @@ namespace lemon
             std::vector<GLchar> error_log(max_length);
             glGetShaderInfoLog(shader, max_length, &max_length, &error_log[0]);
 
-            log.error("SHADER COMPILE ERROR:\n" + (std::string)error_log.data() + "\n");
+            log.error("SHADER COMPILE ERROR:\n{}\n", error_log.data());
         } else
             log.info("Shader compiled with no error messages");
 
@@ -71,6 +74,6 @@ namespace lemon
 
     void gl_program::_use()
     {
-        glUseProgram(this->pointer);
+        static_cast<gl_context*>(this->in_context.get())->state().use_program(this->pointer);
     }
 }
\ No newline at end of file
@@ -12,47 +12,62 @@
 
 namespace lemon
 {
+    /**
+     * @brief Converts read and write flags to an OpenGL access qualifier.
+     */
+    GLenum _map_access(bool read, bool write)
+    {
+        if (read && write)
+            return GL_READ_WRITE;
+        else if (read)
+            return GL_READ_ONLY;
+        else
+            return GL_WRITE_ONLY;
+    }
+
+    gl_state& gl_ssbo::_state()
+    {
+        return static_cast<gl_context*>(this->in_context.get())->state();
+    }
+
     gl_ssbo::gl_ssbo(std::shared_ptr<context> in_context, int index) : shader_buffer(in_context)
     {
         this->index = index;
 
-        this->in_context->perform([&]()
+        // Later operations on this buffer are queued behind its creation, so
+        // there is no need to wait for the buffer name
+        this->in_context->perform([this]()
         {
             glGenBuffers(1, &this->pointer);
-        }, true);
+        });
     }
 
     gl_ssbo::~gl_ssbo()
     {
+        // Waiting also ensures queued operations referencing this buffer
+        // have completed before it is deallocated
         this->in_context->perform([&]()
         {
-            glBindBufferBase(buffer_type, index, GL_NONE);
+            this->_state().bind_buffer_base(buffer_type, index, GL_NONE);
             glDeleteBuffers(1, &this->pointer);
+            this->_state().forget_buffer(this->pointer);
         }, true);
     }
 
     void* gl_ssbo::map(bool read, bool write)
     {
-        GLenum access;
-
-        if (read && write)
-            access = GL_READ_WRITE;
-        else if (read)
-            access = GL_READ_ONLY;
-        else if (write)
-            access = GL_WRITE_ONLY;
-        else
+        if (!read && !write)
         {
             this->log.error("Attempted to map a buffer with neither read nor write enabled");
             return nullptr;
         }
+        auto access = _map_access(read, write);
 
-        void*& mapped = this->mapped;
         this->in_context->perform([&]()
         {
             if (mapped == nullptr)
             {
-                glBindBuffer(buffer_type, pointer);
+                this->_state().bind_buffer(buffer_type, pointer);
                 mapped = glMapBuffer(buffer_type, access);
             }
         }, true);
@@ -60,17 +75,34 @@ namespace lemon
         return mapped;
     }
 
-    void gl_ssbo::unmap()
+    future<void*> gl_ssbo::map_async(bool read, bool write)
     {
-        auto buffer_type = this->buffer_type;
-        auto pointer = this->pointer;
-        void*& mapped = this->mapped;
+        if (!read && !write)
+        {
+            this->log.error("Attempted to map a buffer with neither read nor write enabled");
+            return make_ready_future<void*>(nullptr);
+        }
+        auto access = _map_access(read, write);
+
+        return this->in_context->perform_async([this, access]()
+        {
+            if (mapped == nullptr)
+            {
+                this->_state().bind_buffer(buffer_type, pointer);
+                mapped = glMapBuffer(buffer_type, access);
+            }
+
+            return mapped;
+        });
+    }
 
-        this->in_context->perform([=, &mapped]()
+    void gl_ssbo::unmap()
+    {
+        this->in_context->perform([this]()
         {
             if (mapped != nullptr)
             {
-                glBindBuffer(buffer_type, pointer);
+                this->_state().bind_buffer(buffer_type, pointer);
                 glUnmapBuffer(buffer_type);
                 mapped = nullptr;
             }
@@ -79,26 +111,25 @@ namespace lemon
 
     void gl_ssbo::put(void* data, int size)
     {
-        auto buffer_type = this->buffer_type;
-        auto buffer_usage = this->buffer_usage;
-        auto pointer = this->pointer;
-
-        this->in_context->perform([=]()
+        this->in_context->perform([this, data, size]()
         {
-            glBindBuffer(buffer_type, pointer);
+            this->_state().bind_buffer(buffer_type, pointer);
             glBufferData(buffer_type, size, data, buffer_usage);
         });
     }
 
     void gl_ssbo::bind_base()
     {
-        auto buffer_type = this->buffer_type;
-        auto index = this->index;
-        auto pointer = this->pointer;
-
-        this->in_context->perform([=]()
+        this->in_context->perform([this]()
         {
-            glBindBufferBase(buffer_type, index, pointer);
+            this->_state().bind_buffer_base(buffer_type, index, pointer);
         });
     }
+
+    void gl_ssbo::bind_base(gl_command_buffer& commands)
+    {
+        // Share ownership of this buffer through its name
+        commands.bind_buffer_base(this->buffer_type, this->index,
+            std::shared_ptr<const GLuint>(this->shared_from_this(), &this->pointer));
+    }
 }
\ No newline at end of file
@@ -19,7 +19,7 @@
 
 namespace lemon
 {
-    class gl_ssbo : public shader_buffer
+    class gl_ssbo : public shader_buffer, public std::enable_shared_from_this<gl_ssbo>
     {
         protected:
             GLuint pointer;
@@ -32,6 +32,12 @@ namespace lemon
 
             void* mapped = nullptr;
 
+            /**
+             * @brief State cache of the buffer's context; only to be used on
+             *      the context thread.
+             */
+            gl_state& _state();
+
         public:
             gl_ssbo(std::shared_ptr<context> in_context, int index);
 
@@ -39,10 +45,23 @@ namespace lemon
 
             void* map(bool read, bool write);
 
+            future<void*> map_async(bool read, bool write);
+
             void unmap();
 
             void put(void* data, int size);
 
             void bind_base();
+
+            /**
+             * The command buffer shares ownership of this buffer until it is
+             * reset after its replay, so the buffer may be released before
+             * the commands are submitted.  The buffer must be owned by a
+             * `std::shared_ptr`, as when created by its extension.
+             * 
+             * @brief Records binding this buffer to its index, rather than
+             *      performing the binding as its own task.
+             */
+            void bind_base(gl_command_buffer& commands);
     };
 }
\ No newline at end of file
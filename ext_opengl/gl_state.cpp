@@ -0,0 +1,144 @@
+#include "gl_state.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace lemon
+{
+    void gl_state::bind_buffer(GLenum target, GLuint buffer)
+    {
+        auto bound = this->buffers.find(target);
+        if (!this->_issue(bound != this->buffers.end() && bound->second == buffer))
+            return;
+
+        glBindBuffer(target, buffer);
+        this->buffers[target] = buffer;
+    }
+
+    void gl_state::bind_buffer_base(GLenum target, GLuint index, GLuint buffer)
+    {
+        auto key = ((uint64_t)target << 32) | index;
+
+        auto bound = this->indexed_buffers.find(key);
+        if (!this->_issue(bound != this->indexed_buffers.end() && bound->second == buffer))
+            return;
+
+        glBindBufferBase(target, index, buffer);
+        this->indexed_buffers[key] = buffer;
+        this->buffers[target] = buffer;
+    }
+
+    void gl_state::use_program(GLuint program)
+    {
+        if (!this->_issue(this->program_known && this->program == program))
+            return;
+
+        glUseProgram(program);
+        this->program = program;
+        this->program_known = true;
+    }
+
+    void gl_state::bind_vertex_array(GLuint vertex_array)
+    {
+        if (!this->_issue(this->vertex_array_known && this->vertex_array == vertex_array))
+            return;
+
+        glBindVertexArray(vertex_array);
+        this->vertex_array = vertex_array;
+        this->vertex_array_known = true;
+    }
+
+    void gl_state::viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+    {
+        auto& rect = this->viewport_rect;
+        if (!this->_issue(this->viewport_known
+            && rect[0] == x && rect[1] == y && rect[2] == width && rect[3] == height))
+            return;
+
+        glViewport(x, y, width, height);
+        rect[0] = x;
+        rect[1] = y;
+        rect[2] = width;
+        rect[3] = height;
+        this->viewport_known = true;
+    }
+
+    void gl_state::clear_color(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+    {
+        auto& rgba = this->clear_rgba;
+        if (!this->_issue(this->clear_color_known
+            && rgba[0] == red && rgba[1] == green && rgba[2] == blue && rgba[3] == alpha))
+            return;
+
+        glClearColor(red, green, blue, alpha);
+        rgba[0] = red;
+        rgba[1] = green;
+        rgba[2] = blue;
+        rgba[3] = alpha;
+        this->clear_color_known = true;
+    }
+
+    void gl_state::_set_capability(GLenum capability, bool enabled)
+    {
+        for (auto& known : this->capabilities)
+            if (known.first == capability)
+            {
+                if (!this->_issue(known.second == enabled))
+                    return;
+
+                if (enabled)
+                    glEnable(capability);
+                else
+                    glDisable(capability);
+                known.second = enabled;
+                return;
+            }
+
+        this->_issue(false);
+        if (enabled)
+            glEnable(capability);
+        else
+            glDisable(capability);
+        this->capabilities.emplace_back(capability, enabled);
+    }
+
+    void gl_state::forget_buffer(GLuint buffer)
+    {
+        // Deleting a buffer resets its bindings; assume nothing about them
+        std::erase_if(this->buffers, [=](auto& bound) { return bound.second == buffer; });
+        std::erase_if(this->indexed_buffers, [=](auto& bound) { return bound.second == buffer; });
+    }
+
+    void gl_state::forget_program(GLuint program)
+    {
+        if (this->program == program)
+            this->program_known = false;
+    }
+
+    void gl_state::invalidate()
+    {
+        this->buffers.clear();
+        this->indexed_buffers.clear();
+        this->capabilities.clear();
+
+        this->program_known = false;
+        this->vertex_array_known = false;
+        this->viewport_known = false;
+        this->clear_color_known = false;
+    }
+
+    gl_state_counters gl_state::take_counters()
+    {
+        auto counters = this->counters;
+        this->counters = { };
+
+        return counters;
+    }
+}
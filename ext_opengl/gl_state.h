@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "GL/glew.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace lemon
+{
+    /**
+     * @brief Numbers of state-changing calls which reached the driver, and
+     *      which were filtered as redundant.
+     */
+    struct gl_state_counters
+    {
+        uint64_t issued = 0;
+        uint64_t filtered = 0;
+    };
+
+    /**
+     * Each call compares the requested state to the state last set through
+     * the cache, and only reaches the driver if they differ.  State which has
+     * not been set through the cache is unknown and always set.  Code which
+     * changes state without the cache must call `invalidate` afterwards.
+     *
+     * Owned by a context and only used on its context thread.
+     *
+     * @brief Shadow of an OpenGL context's bindings and enabled capabilities.
+     * @author Zach Goethel
+     */
+    class gl_state
+    {
+        private:
+            /**
+             * @brief Buffer bound to each target, and to each indexed binding
+             *      point keyed by target and index.
+             */
+            std::unordered_map<GLenum, GLuint> buffers;
+            std::unordered_map<uint64_t, GLuint> indexed_buffers;
+
+            GLuint program = 0;
+            bool program_known = false;
+
+            GLuint vertex_array = 0;
+            bool vertex_array_known = false;
+
+            GLint viewport_rect[4] = { };
+            bool viewport_known = false;
+
+            GLfloat clear_rgba[4] = { };
+            bool clear_color_known = false;
+
+            /**
+             * @brief Capabilities set through the cache and whether each is
+             *      enabled; few are ever used, so they are searched linearly.
+             */
+            std::vector<std::pair<GLenum, bool>> capabilities;
+
+            gl_state_counters counters;
+
+            /**
+             * @brief Counts a call, returning whether it must be issued.
+             */
+            bool _issue(bool redundant)
+            {
+                if (redundant)
+                    this->counters.filtered++;
+                else
+                    this->counters.issued++;
+
+                return !redundant;
+            }
+
+            void _set_capability(GLenum capability, bool enabled);
+
+        public:
+            void bind_buffer(GLenum target, GLuint buffer);
+
+            /**
+             * @brief Binds a buffer to an indexed binding point, which also
+             *      binds it to the target's generic binding point.
+             */
+            void bind_buffer_base(GLenum target, GLuint index, GLuint buffer);
+
+            void use_program(GLuint program);
+
+            void bind_vertex_array(GLuint vertex_array);
+
+            void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+            void clear_color(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+
+            void enable(GLenum capability)
+            {
+                this->_set_capability(capability, true);
+            }
+
+            void disable(GLenum capability)
+            {
+                this->_set_capability(capability, false);
+            }
+
+            /**
+             * @brief Forgets any binding of a buffer which is being deleted,
+             *      so that a buffer later given the same name is bound again.
+             */
+            void forget_buffer(GLuint buffer);
+
+            /**
+             * @brief Forgets the current program if it is being deleted.
+             */
+            void forget_program(GLuint program);
+
+            /**
+             * @brief Marks all state as unknown, such that each next call is
+             *      issued.
+             */
+            void invalidate();
+
+            /**
+             * @brief Returns the counts of calls since the previous call, and
+             *      resets them.
+             */
+            gl_state_counters take_counters();
+    };
+}
@@ -0,0 +1,125 @@
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <optional>
+
+#include "core/future.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace lemon;
+
+/**
+ * @brief Runs continuations immediately on the completing thread.
+ */
+struct inline_executor
+{
+    void execute(task job)
+    {
+        job();
+    }
+};
+
+/**
+ * @brief Checks whether getting the future throws the provided error code.
+ */
+template <typename T>
+bool throws(future<T>& result, std::future_errc code)
+{
+    try
+    {
+        result.get();
+    } catch(const std::future_error& ex)
+    {
+        return ex.code() == code;
+    }
+
+    return false;
+}
+
+bool check(const char* name, bool passed)
+{
+    printf("%s: %s\n", passed ? "PASS" : "FAIL", name);
+    return passed;
+}
+
+int main()
+{
+    bool passed = true;
+
+    {   /* DESTROYED BEFORE FULFILLING */
+        std::optional<promise<int>> dropped;
+        dropped.emplace();
+        auto result = dropped->get_future();
+        dropped.reset();
+
+        passed &= check("dropped promise breaks its future", result.ready()
+            && throws(result, std::future_errc::broken_promise));
+    }
+
+    {   /* DROPPED TASK HOLDING THE PROMISE */
+        promise<int> captured;
+        auto result = captured.get_future();
+        {
+            task job = [captured = std::move(captured)]() mutable
+            {
+                captured.set_value(1);
+            };
+        }
+
+        passed &= check("dropped task breaks its future",
+            throws(result, std::future_errc::broken_promise));
+    }
+
+    {   /* CONTINUATION OF A BROKEN PROMISE */
+        inline_executor executor;
+        std::optional<promise<void>> dropped;
+        dropped.emplace();
+
+        bool invoked = false;
+        auto chained = dropped->get_future().then(executor, [&]()
+        {
+            invoked = true;
+        });
+        dropped.reset();
+
+        passed &= check("continuation receives the broken promise", !invoked
+            && throws(chained, std::future_errc::broken_promise));
+    }
+
+    {   /* MOVED PROMISE STAYS PENDING */
+        promise<int> first;
+        auto result = first.get_future();
+        promise<int> second = std::move(first);
+        second.set_value(7);
+
+        passed &= check("moved promise fulfills once", result.get() == 7);
+    }
+
+    {   /* COMPLETING TWICE */
+        promise<int> twice;
+        auto result = twice.get_future();
+        twice.set_value(1);
+
+        bool rejected = false;
+        try
+        {
+            twice.set_value(2);
+        } catch(const std::future_error& ex)
+        {
+            rejected = ex.code() == std::future_errc::promise_already_satisfied;
+        }
+
+        passed &= check("second completion is rejected", rejected && result.get() == 1);
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,80 @@
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "core/logger.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace lemon;
+
+bool check(const char* name, bool passed)
+{
+    printf("%s: %s\n", passed ? "PASS" : "FAIL", name);
+    return passed;
+}
+
+/**
+ * @brief Logs a message with a new logger of the provided pattern, and
+ *      returns the text written to the console.
+ */
+std::string format(const char* pattern, const char* name, const char* message)
+{
+    std::ostringstream captured;
+    auto console = std::cout.rdbuf(captured.rdbuf());
+
+    logger log(pattern, name);
+    log.info(message);
+
+    std::cout.rdbuf(console);
+    return captured.str();
+}
+
+/**
+ * @brief Checks text against a shape, where each '#' matches any digit.
+ */
+bool matches(const std::string& text, const std::string& shape)
+{
+    if (text.length() != shape.length())
+        return false;
+
+    for (size_t i = 0; i < text.length(); i++)
+        if (shape[i] == '#' ? !isdigit((unsigned char)text[i]) : text[i] != shape[i])
+            return false;
+
+    return true;
+}
+
+int main()
+{
+    bool passed = true;
+
+    {   /* LEADING DATE FIELD */
+        auto text = format("%d{yyyy-MM-dd} %m%n", "x", "hello");
+        passed &= check("pattern starting with a date", matches(text, "####-##-## hello\n"));
+    }
+
+    {   /* LEADING TIME FIELD */
+        // Widths pad after the text, and "-" widths before it
+        auto text = format("%t{hh:mm:ss}|%-6c|%4m%n", "abc", "hi");
+        passed &= check("pattern starting with a time", matches(text, "##:##:##|   abc|hi  \n"));
+    }
+
+    {   /* DATE FIELD ONLY */
+        auto text = format("%d{yyyyMMdd}", "x", "ignored");
+        passed &= check("pattern of only a date", matches(text, "########"));
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
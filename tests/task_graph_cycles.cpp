@@ -0,0 +1,108 @@
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <utility>
+
+#include "core/task_graph.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace lemon;
+
+// Layers of two jobs, each depending on both jobs of the previous layer
+#define DIAMOND_LAYERS 40
+// Jobs in a single dependency chain
+#define CHAIN_LENGTH 200000
+
+bool check(const char* name, bool passed)
+{
+    printf("%s: %s\n", passed ? "PASS" : "FAIL", name);
+    return passed;
+}
+
+/**
+ * @brief Checks whether declaring the edge is rejected as a cycle.
+ */
+bool rejects(task_graph& graph, int before, int after)
+{
+    try
+    {
+        graph.precede(before, after);
+    } catch(const std::runtime_error&)
+    {
+        return true;
+    }
+
+    return false;
+}
+
+int main()
+{
+    bool passed = true;
+
+    {   /* LAYERED DIAMONDS */
+        // Paths double with each layer; the check must not enumerate them
+        task_graph graph;
+        int prev[2] = { graph.add("a0", []() { }), graph.add("b0", []() { }) };
+
+        for (int layer = 1; layer < DIAMOND_LAYERS; layer++)
+        {
+            int next[2] = { graph.add("a", []() { }), graph.add("b", []() { }) };
+            for (auto before : prev)
+                for (auto after : next)
+                    graph.precede(before, after);
+
+            prev[0] = next[0];
+            prev[1] = next[1];
+        }
+
+        int entry = graph.add("entry", []() { });
+        passed &= check("closing edge across diamonds is rejected", rejects(graph, prev[0], 0));
+        passed &= check("edge into the diamonds is accepted", !rejects(graph, entry, 0));
+    }
+
+    {   /* LONG CHAIN */
+        // Deep enough to overflow the stack of a recursive search
+        task_graph graph;
+        int first = graph.add("first", []() { });
+        int last = first;
+
+        for (int i = 1; i < CHAIN_LENGTH; i++)
+        {
+            int next = graph.add("link", []() { });
+            graph.precede(last, next);
+            last = next;
+        }
+
+        int head = graph.add("head", []() { });
+        passed &= check("closing edge of a long chain is rejected", rejects(graph, last, first));
+        passed &= check("edge into a long chain is accepted", !rejects(graph, head, first));
+    }
+
+    {   /* UNKNOWN JOBS */
+        task_graph graph;
+        int only = graph.add("only", []() { });
+
+        int rejected = 0;
+        for (auto edge : { std::pair { only, 1 }, std::pair { -1, only }, std::pair { 5, 7 } })
+            try
+            {
+                graph.precede(edge.first, edge.second);
+            } catch(const std::out_of_range&)
+            {
+                rejected++;
+            }
+
+        passed &= check("edges naming unknown jobs are rejected", rejected == 3);
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,120 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core/logger.h"
+#include "core/task_graph.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace lemon;
+
+// Jobs in each layer of the tested graph
+#define LAYER_WIDTH 8
+// Runs of the graph per check
+#define RUNS 50
+
+bool check(const char* name, bool passed)
+{
+    printf("%s: %s\n", passed ? "PASS" : "FAIL", name);
+    return passed;
+}
+
+/**
+ * @brief Builds a graph of two layers, where every job of the second depends
+ *      on every job of the first, recording any job started too early.
+ */
+void build(task_graph& graph, std::atomic<int>& finished, std::atomic<int>& early)
+{
+    std::vector<int> first;
+    for (int i = 0; i < LAYER_WIDTH; i++)
+        first.push_back(graph.add("first", [&finished]()
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            finished.fetch_add(1);
+        }));
+
+    for (int i = 0; i < LAYER_WIDTH; i++)
+    {
+        int second = graph.add("second", [&finished, &early]()
+        {
+            if (finished.load() % (LAYER_WIDTH * 2) < LAYER_WIDTH)
+                early.fetch_add(1);
+            finished.fetch_add(1);
+        });
+
+        for (auto before : first)
+            graph.precede(before, second);
+    }
+}
+
+/**
+ * @brief Waits for a flag, giving up after a few seconds.
+ */
+bool await(std::atomic<bool>& flag)
+{
+    auto until = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!flag.load() && std::chrono::steady_clock::now() < until)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    return flag.load();
+}
+
+int main()
+{
+    // Keep pool startup messages out of the results
+    logger::set_level(log_level::info);
+    bool passed = true;
+
+    {   /* RUN FROM OUTSIDE THE POOL */
+        worker_pool pool(4);
+        task_graph graph;
+        std::atomic<int> finished { 0 }, early { 0 };
+        build(graph, finished, early);
+
+        for (int i = 0; i < RUNS; i++)
+            graph.run(pool);
+
+        passed &= check("every job runs once per run", finished.load() == RUNS * LAYER_WIDTH * 2);
+        passed &= check("no job starts before its predecessors", early.load() == 0);
+    }
+
+    {   /* RUN FROM THE ONLY WORKER */
+        // The pool is leaked, as a hung run would keep its worker busy
+        auto pool = new worker_pool(1);
+        task_graph graph;
+        std::atomic<int> finished { 0 }, early { 0 };
+        build(graph, finished, early);
+
+        std::atomic<bool> done { false };
+        pool->execute([&]()
+        {
+            for (int i = 0; i < RUNS; i++)
+                graph.run(*pool);
+            done.store(true);
+        });
+
+        passed &= check("run from the pool's only worker completes", await(done));
+        passed &= check("no job starts before its predecessors from a worker", done.load() && early.load() == 0);
+
+        if (!done.load())
+        {
+            fflush(stdout);
+            _Exit(EXIT_FAILURE);
+        }
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
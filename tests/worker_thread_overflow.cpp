@@ -0,0 +1,122 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+#include "core/worker_thread.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace lemon;
+
+// Tasks queued by each check; several times a lane's capacity
+#define TASK_COUNT (WORKER_QUEUE_CAPACITY * 4)
+
+/**
+ * @brief Counts tasks as they run, and whether they ran in order.
+ */
+struct ordered_counter
+{
+    std::atomic<int> next { 0 };
+    std::atomic<bool> ordered { true };
+
+    void run(int index)
+    {
+        if (this->next.fetch_add(1) != index)
+            this->ordered = false;
+    }
+};
+
+/**
+ * @brief Waits until the worker thread has run every task queued before.
+ */
+bool drain(worker_thread& worker)
+{
+    std::counting_semaphore<1> done { 0 };
+    worker.execute([&]()
+    {
+        done.release();
+    });
+
+    return done.try_acquire_for(std::chrono::seconds(10));
+}
+
+bool check(const char* name, bool passed)
+{
+    printf("%s: %s\n", passed ? "PASS" : "FAIL", name);
+    return passed;
+}
+
+int main()
+{
+    // Worker threads run until the process exits
+    auto& worker = *new worker_thread();
+    bool passed = true;
+
+    {   /* FILL A LANE FROM ITS OWN THREAD */
+        ordered_counter counter;
+        worker.execute([&]()
+        {
+            for (int i = 0; i < TASK_COUNT; i++)
+                worker.execute([&, i]()
+                {
+                    counter.run(i);
+                });
+        });
+
+        passed &= check("execute onto own full lane", drain(worker)
+            && counter.next == TASK_COUNT && counter.ordered);
+    }
+
+    {   /* BATCH ONTO ITS OWN THREAD */
+        ordered_counter counter;
+        worker.execute([&]()
+        {
+            std::vector<task> tasks;
+            for (int i = 0; i < TASK_COUNT; i++)
+                tasks.push_back([&, i]()
+                {
+                    counter.run(i);
+                });
+
+            worker.execute_batch(tasks.data(), tasks.size());
+        });
+
+        passed &= check("execute_batch onto own lane", drain(worker)
+            && counter.next == TASK_COUNT && counter.ordered);
+    }
+
+    {   /* FILL A LANE WHILE HOLDING A LOCK ITS THREAD WAITS FOR */
+        ordered_counter counter;
+        std::mutex held;
+
+        held.lock();
+        worker.execute([&]()
+        {
+            std::lock_guard<std::mutex> lock(held);
+        });
+        for (int i = 0; i < TASK_COUNT; i++)
+            worker.execute([&, i]()
+            {
+                counter.run(i);
+            });
+        held.unlock();
+
+        passed &= check("execute while the worker waits on the producer", drain(worker)
+            && counter.next == TASK_COUNT && counter.ordered);
+    }
+
+    fflush(stdout);
+    // Skip destruction of the still-running worker thread
+    _Exit(passed ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,265 @@
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/log_trace.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//                          Lemon 3D Graphics Engine                          //
+//                    COPYRIGHT (c) 2021 by ZACH GOETHEL                      //
+//  ------------------------------------------------------------------------  //
+//  Use freely.  This code is published under the MIT permissive open-source  //
+//  license.  For more information, see the license file included with this   //
+//  repository.  Good luck, and enjoy!                                        //
+//  ------------------------------------------------------------------------  //
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace lemon;
+
+/**
+ * @brief A decoded argument, as its text and whether it is a string.
+ */
+struct decoded_arg
+{
+    std::string text;
+    bool quoted = false;
+};
+
+/**
+ * @brief Reads one tagged argument of a trace record.
+ */
+decoded_arg read_arg(trace_reader& reader)
+{
+    decoded_arg arg;
+    char digits[512];
+
+    switch (reader.get<trace_arg>())
+    {
+    case trace_arg::int64:
+        arg.text.assign(digits, std::to_chars(digits, digits + sizeof(digits), reader.get<int64_t>()).ptr);
+        break;
+    case trace_arg::uint64:
+        arg.text.assign(digits, std::to_chars(digits, digits + sizeof(digits), reader.get<uint64_t>()).ptr);
+        break;
+    case trace_arg::float64:
+    {
+        // Six decimals, matching the logger's text output
+        auto value = reader.get<double>();
+        arg.text.assign(digits, std::to_chars(digits, digits + sizeof(digits),
+            value, std::chars_format::fixed, 6).ptr);
+        // JSON has no literals for infinity or NaN
+        arg.quoted = !std::isfinite(value);
+        break;
+    }
+    case trace_arg::boolean:
+        arg.text = reader.get<uint8_t>() ? "true" : "false";
+        break;
+    case trace_arg::character:
+        arg.text = reader.get<char>();
+        arg.quoted = true;
+        break;
+    case trace_arg::string:
+        arg.text = reader.get_string();
+        arg.quoted = true;
+        break;
+    default:
+        reader.truncated = true;
+    }
+
+    return arg;
+}
+
+/**
+ * @brief Replaces each "{}" of a format string with the next argument.
+ */
+std::string substitute(std::string_view format, const std::vector<decoded_arg>& args)
+{
+    std::string message;
+    size_t next = 0;
+
+    while (next < args.size())
+    {
+        auto hole = format.find("{}");
+        if (hole == std::string_view::npos)
+            break;
+
+        message += format.substr(0, hole);
+        message += args[next++].text;
+        format = format.substr(hole + 2);
+    }
+
+    message += format;
+    return message;
+}
+
+/**
+ * @brief Appends a string as a quoted JSON string.
+ */
+void append_json(std::string& out, std::string_view value)
+{
+    out += '"';
+    for (unsigned char c : value)
+        switch (c)
+        {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (c < 0x20)
+            {
+                char escape[8];
+                snprintf(escape, sizeof(escape), "\\u%04x", c);
+                out += escape;
+            } else
+                out += (char)c;
+        }
+    out += '"';
+}
+
+int main(int argc, char** argv)
+{
+    const char* levels[] = { "DEBUG", "INFO", "WARN", "ERROR" };
+
+    // Parse the output mode and input file
+    bool json = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; i++)
+        if (std::string(argv[i]) == "--json")
+            json = true;
+        else
+            path = argv[i];
+
+    if (path == nullptr)
+    {
+        fprintf(stderr, "Usage: %s [--json] <trace file>\n", argv[0]);
+        return 2;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!file && !file.eof())
+    {
+        fprintf(stderr, "Could not read '%s'\n", path);
+        return 1;
+    }
+
+    trace_reader reader { data.data(), data.size() };
+
+    // Validate the header
+    std::string_view magic = LOG_TRACE_MAGIC;
+    if (data.compare(0, magic.size(), magic) != 0)
+    {
+        fprintf(stderr, "'%s' is not a trace log\n", path);
+        return 1;
+    }
+    reader.offset = magic.size();
+    auto version = reader.get<uint32_t>();
+    if (version != LOG_TRACE_VERSION)
+    {
+        fprintf(stderr, "Unsupported trace log version %u\n", version);
+        return 1;
+    }
+
+    std::unordered_map<uint32_t, std::string> formats, sources;
+    std::vector<decoded_arg> args;
+    std::string line;
+
+    while (!reader.done())
+    {
+        auto tag = reader.get<trace_tag>();
+        if (tag == trace_tag::format || tag == trace_tag::source)
+        {
+            auto id = reader.get<uint32_t>();
+            auto text = reader.get_string();
+            (tag == trace_tag::format ? formats : sources)[id] = text;
+            continue;
+        }
+        if (tag != trace_tag::record)
+        {
+            fprintf(stderr, "Unknown entry at offset %zu\n", reader.offset - 1);
+            return 1;
+        }
+
+        auto time = reader.get<int64_t>();
+        auto thread = reader.get<uint32_t>();
+        auto source = reader.get<uint32_t>();
+        auto level = reader.get<uint8_t>();
+        auto format_id = reader.get<uint32_t>();
+        auto count = reader.get<uint8_t>();
+
+        args.clear();
+        for (int i = 0; i < count; i++)
+            args.push_back(read_arg(reader));
+        if (reader.truncated)
+            break;
+
+        // Records without an interned format carry it as the first argument
+        std::string format;
+        if (format_id == 0 && !args.empty())
+        {
+            format = args.front().text;
+            args.erase(args.begin());
+        } else
+            format = formats[format_id];
+
+        auto message = substitute(format, args);
+        auto level_name = level < 4 ? levels[level] : "?";
+
+        line.clear();
+        if (json)
+        {
+            line += "{\"time\":" + std::to_string(time);
+            line += ",\"thread\":" + std::to_string(thread);
+            line += ",\"logger\":";
+            append_json(line, sources[source]);
+            line += ",\"level\":";
+            append_json(line, level_name);
+            line += ",\"format\":";
+            append_json(line, format);
+            line += ",\"args\":[";
+            for (size_t i = 0; i < args.size(); i++)
+            {
+                if (i > 0)
+                    line += ',';
+                if (args[i].quoted)
+                    append_json(line, args[i].text);
+                else
+                    line += args[i].text;
+            }
+            line += "],\"message\":";
+            append_json(line, message);
+            line += "}\n";
+        } else
+        {
+            // Local time with millisecond precision
+            time_t seconds = (time_t)(time / 1000000000);
+            char stamp[64];
+            strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", localtime(&seconds));
+
+            char prefix[160];
+            snprintf(prefix, sizeof(prefix), "%s.%03d [%-5s][%15s] (thread %u): ",
+                stamp, (int)(time / 1000000 % 1000), level_name, sources[source].c_str(), thread);
+            line += prefix;
+            line += message;
+            line += '\n';
+        }
+
+        fwrite(line.data(), 1, line.size(), stdout);
+    }
+
+    if (reader.truncated)
+    {
+        fprintf(stderr, "Trace log ends with a truncated entry\n");
+        return 1;
+    }
+
+    return 0;
+}